@@ -0,0 +1,370 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "capture_backend.h"
+#include "pic_deal.h"
+#include "shibie_Square_min.h"
+#include <opencv2/opencv.hpp>
+
+/**
+ * 正方形识别基准测试
+ * 将录制的图片目录或视频全部载入内存后逐帧回放，分别统计识别流程各阶段
+ * 以及 PicDeal 各接口的耗时，输出最小值、中位数、p99 和帧率
+ *
+ * 用法: bench_square <图片目录或视频> [--passes <遍数>] [--warmup <帧数>] [--max-frames <帧数>]
+ *                    [--pyramid <层数>] [--subpix] [--label <标签>] [--json <文件>] [--csv <文件>]
+ */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// 计算两个时间点之间的微秒数
+double elapsedMicros(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+// 一个阶段的耗时样本（微秒）
+struct StageSamples {
+    std::string name;
+    std::vector<double> samples;
+};
+
+// 一个阶段的统计结果
+struct StageSummary {
+    std::string name;
+    size_t count;
+    double min_us;
+    double median_us;
+    double p99_us;
+    double mean_us;
+    double fps; // 按平均耗时换算的每秒帧数
+};
+
+// 对样本排序后取百分位
+StageSummary summarize(const StageSamples& stage) {
+    StageSummary summary;
+    summary.name = stage.name;
+    summary.count = stage.samples.size();
+    summary.min_us = summary.median_us = summary.p99_us = summary.mean_us = summary.fps = 0;
+    if (stage.samples.empty()) {
+        return summary;
+    }
+
+    std::vector<double> sorted = stage.samples;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0;
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        sum += sorted[i];
+    }
+    summary.min_us = sorted.front();
+    summary.median_us = sorted[sorted.size() / 2];
+    summary.p99_us = sorted[std::min(sorted.size() - 1, static_cast<size_t>(sorted.size() * 0.99))];
+    summary.mean_us = sum / sorted.size();
+    summary.fps = summary.mean_us > 0 ? 1e6 / summary.mean_us : 0;
+    return summary;
+}
+
+// 计时辅助：记录从上一次打点到现在的耗时
+class StageTimer {
+public:
+    explicit StageTimer(std::vector<StageSamples>& stages) : stages_(stages), last_(Clock::now()) {}
+
+    void mark(size_t stage, bool record) {
+        Clock::time_point now = Clock::now();
+        if (record) {
+            stages_[stage].samples.push_back(elapsedMicros(last_, now));
+        }
+        last_ = now;
+    }
+
+private:
+    std::vector<StageSamples>& stages_;
+    Clock::time_point last_;
+};
+
+// 各阶段下标
+enum Stage {
+    STAGE_GRAY,
+    STAGE_PYRAMID,
+    STAGE_BLUR,
+    STAGE_CANNY,
+    STAGE_CONTOURS,
+    STAGE_QUADS,
+    STAGE_SUBPIX,
+    STAGE_FILTER,
+    STAGE_MIN,
+    STAGE_TOTAL,
+    STAGE_PICDEAL_CAPTURE,
+    STAGE_PICDEAL_GRAY,
+    STAGE_PICDEAL_EDGES,
+    STAGE_PICDEAL_CONTOURS,
+    STAGE_PICDEAL_BINARY,
+    STAGE_COUNT
+};
+
+const char* const kStageNames[STAGE_COUNT] = {
+    "gray", "pyramid", "blur", "canny", "contours", "quads", "subpix", "filter", "min_square", "shibie_Square_min",
+    "picdeal.capture", "picdeal.gray", "picdeal.edges", "picdeal.contours", "picdeal.binarize"
+};
+
+// 把语料全部解码到内存，计时时不包含磁盘读取和解码
+bool loadCorpus(const std::string& path, size_t max_frames, std::vector<cv::Mat>& frames) {
+    ReplayCapture replay(path, false);
+    if (!replay.open()) {
+        return false;
+    }
+    CaptureFrame frame;
+    while ((max_frames == 0 || frames.size() < max_frames) && replay.grab(frame)) {
+        frames.push_back(frame.read_only ? frame.image : frame.image.clone());
+    }
+    return !frames.empty();
+}
+
+// 转义 JSON 字符串中的特殊字符
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            escaped += buf;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+void writeJson(const std::string& file, const std::string& label, const std::string& corpus, const cv::Mat& first,
+               size_t frames, int passes, const SquareDetectOptions& options,
+               const std::vector<StageSummary>& summaries) {
+    std::ofstream out(file.c_str());
+    if (!out) {
+        std::cerr << "无法写入: " << file << std::endl;
+        return;
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "{\n";
+    out << "  \"label\": \"" << jsonEscape(label) << "\",\n";
+    out << "  \"corpus\": \"" << jsonEscape(corpus) << "\",\n";
+    out << "  \"frames\": " << frames << ",\n";
+    out << "  \"passes\": " << passes << ",\n";
+    out << "  \"width\": " << first.cols << ",\n";
+    out << "  \"height\": " << first.rows << ",\n";
+    out << "  \"pyramid_levels\": " << options.pyramid_levels << ",\n";
+    out << "  \"refine_corners\": " << (options.refine_corners ? "true" : "false") << ",\n";
+    out << "  \"stages\": [\n";
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        const StageSummary& s = summaries[i];
+        out << "    {\"name\": \"" << s.name << "\", \"count\": " << s.count << ", \"min_us\": " << s.min_us
+            << ", \"median_us\": " << s.median_us << ", \"p99_us\": " << s.p99_us << ", \"mean_us\": " << s.mean_us
+            << ", \"fps\": " << s.fps << "}" << (i + 1 < summaries.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+// 按 CSV 规则给字段加引号，字段中的引号写两次
+std::string csvQuote(const std::string& text) {
+    std::string quoted = "\"";
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '"') {
+            quoted += '"';
+        }
+        quoted += text[i];
+    }
+    return quoted + "\"";
+}
+
+void writeCsv(const std::string& file, const std::string& label, const std::vector<StageSummary>& summaries) {
+    std::ofstream out(file.c_str());
+    if (!out) {
+        std::cerr << "无法写入: " << file << std::endl;
+        return;
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "label,stage,count,min_us,median_us,p99_us,mean_us,fps\n";
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        const StageSummary& s = summaries[i];
+        out << csvQuote(label) << "," << s.name << "," << s.count << "," << s.min_us << "," << s.median_us << "," << s.p99_us
+            << "," << s.mean_us << "," << s.fps << "\n";
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "用法: " << argv[0] << " <图片目录或视频> [--passes N] [--warmup N] [--max-frames N]"
+                  << " [--pyramid N] [--subpix] [--label 标签] [--json 文件] [--csv 文件]" << std::endl;
+        return -1;
+    }
+
+    // 解析命令行参数
+    std::string corpus = argv[1];
+    int passes = 3;
+    size_t warmup = 5;
+    size_t max_frames = 0;
+    std::string label = "default";
+    std::string json_file;
+    std::string csv_file;
+    SquareDetectOptions options;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--passes" && i + 1 < argc) {
+            passes = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            warmup = static_cast<size_t>(atoi(argv[++i]));
+        } else if (arg == "--max-frames" && i + 1 < argc) {
+            max_frames = static_cast<size_t>(atoi(argv[++i]));
+        } else if (arg == "--pyramid" && i + 1 < argc) {
+            options.pyramid_levels = atoi(argv[++i]);
+            options.refine_corners = true;
+        } else if (arg == "--subpix") {
+            options.refine_corners = true;
+        } else if (arg == "--label" && i + 1 < argc) {
+            label = argv[++i];
+        } else if (arg == "--json" && i + 1 < argc) {
+            json_file = argv[++i];
+        } else if (arg == "--csv" && i + 1 < argc) {
+            csv_file = argv[++i];
+        } else {
+            std::cerr << "未知参数: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    std::vector<cv::Mat> frames;
+    if (!loadCorpus(corpus, max_frames, frames)) {
+        std::cerr << "无法载入测试语料: " << corpus << std::endl;
+        return -1;
+    }
+    std::cout << "已载入 " << frames.size() << " 帧，分辨率 " << frames[0].cols << "x" << frames[0].rows << std::endl;
+
+    std::vector<StageSamples> stages(STAGE_COUNT);
+    for (size_t i = 0; i < stages.size(); ++i) {
+        stages[i].name = kStageNames[i];
+    }
+
+    // 识别流程各阶段，与 shibie_Square_min 使用相同的 --pyramid/--subpix 配置：
+    // 在金字塔层上检测，坐标换算回原图后按需精化顶点；未启用的阶段不记录样本。前 warmup 帧不计入统计
+    size_t processed = 0;
+    cv::Mat gray, level, blurred, edges, result_image;
+    std::vector<std::vector<cv::Point>> contours;
+    std::vector<cv::Vec4i> hierarchy;
+    std::vector<std::vector<cv::Point2f>> squares, non_overlapping;
+    std::vector<double> areas;
+    std::vector<cv::Point2f> min_square;
+    for (int pass = 0; pass < passes; ++pass) {
+        for (size_t f = 0; f < frames.size(); ++f, ++processed) {
+            const cv::Mat& frame = frames[f];
+            bool record = processed >= warmup;
+            squares.clear();
+            non_overlapping.clear();
+            areas.clear();
+
+            StageTimer timer(stages);
+            if (frame.channels() == 1) {
+                gray = frame;
+            } else {
+                cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+            }
+            timer.mark(STAGE_GRAY, record);
+            level = gray;
+            int scale = 1;
+            for (int i = 0; i < options.pyramid_levels && level.cols >= 64 && level.rows >= 64; i++) {
+                cv::Mat down;
+                cv::pyrDown(level, down);
+                level = down;
+                scale *= 2;
+            }
+            timer.mark(STAGE_PYRAMID, record && options.pyramid_levels > 0);
+            cv::GaussianBlur(level, blurred, cv::Size(5, 5), 0);
+            timer.mark(STAGE_BLUR, record);
+            cv::Canny(blurred, edges, 50, 150);
+            timer.mark(STAGE_CANNY, record);
+            cv::findContours(edges, contours, hierarchy, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+            timer.mark(STAGE_CONTOURS, record);
+            fitSquaresFromContours(contours, squares);
+            if (scale > 1) {
+                for (size_t i = 0; i < squares.size(); i++) {
+                    for (auto& point : squares[i]) {
+                        point *= static_cast<float>(scale);
+                    }
+                }
+            }
+            timer.mark(STAGE_QUADS, record);
+            if (options.refine_corners) {
+                refineSquareCorners(gray, squares, scale);
+            }
+            timer.mark(STAGE_SUBPIX, record && options.refine_corners);
+            filterOverlappingSquares(squares, non_overlapping, &areas);
+            timer.mark(STAGE_FILTER, record);
+            findMinSquare(non_overlapping, min_square, &areas);
+            timer.mark(STAGE_MIN, record);
+
+            // 完整调用（含结果图像拷贝和绘制），反映实际每帧开销
+            result_image = frame.clone();
+            Clock::time_point start = Clock::now();
+            shibie_Square_min(frame, result_image, min_square, options);
+            if (record) {
+                stages[STAGE_TOTAL].samples.push_back(elapsedMicros(start, Clock::now()));
+            }
+        }
+    }
+
+    // PicDeal 接口：通过回放后端逐帧读取，统计取帧和各处理接口的耗时
+    PicDeal pic_deal;
+    if (pic_deal.openCapture(std::unique_ptr<CaptureBackend>(new ReplayCapture(corpus, true)))) {
+        cv::Mat out;
+        size_t total = frames.size() * passes;
+        for (size_t n = 0; n < total; ++n) {
+            bool record = n >= warmup;
+            StageTimer timer(stages);
+            pic_deal.getCurrentImage();
+            timer.mark(STAGE_PICDEAL_CAPTURE, record);
+            pic_deal.toGrayscale(out);
+            timer.mark(STAGE_PICDEAL_GRAY, record);
+            pic_deal.edgeDetection(50, 150, out);
+            timer.mark(STAGE_PICDEAL_EDGES, record);
+            pic_deal.findContours(contours, hierarchy);
+            timer.mark(STAGE_PICDEAL_CONTOURS, record);
+            pic_deal.binarize(128, out);
+            timer.mark(STAGE_PICDEAL_BINARY, record);
+        }
+    }
+
+    // 输出统计
+    std::vector<StageSummary> summaries;
+    for (size_t i = 0; i < stages.size(); ++i) {
+        summaries.push_back(summarize(stages[i]));
+    }
+
+    std::cout << std::left << std::setw(20) << "stage" << std::right << std::setw(10) << "min(us)" << std::setw(12)
+              << "median(us)" << std::setw(10) << "p99(us)" << std::setw(10) << "fps" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        const StageSummary& s = summaries[i];
+        std::cout << std::left << std::setw(20) << s.name << std::right << std::setw(10) << s.min_us << std::setw(12)
+                  << s.median_us << std::setw(10) << s.p99_us << std::setw(10) << s.fps << std::endl;
+    }
+
+    if (!json_file.empty()) {
+        writeJson(json_file, label, corpus, frames[0], frames.size(), passes, options, summaries);
+    }
+    if (!csv_file.empty()) {
+        writeCsv(csv_file, label, summaries);
+    }
+    return 0;
+}
@@ -9,24 +9,30 @@ CXX=g++
 # 设置编译选项
 CXXFLAGS="-std=c++11 -Wall -Wextra -O2"
 
+# 数字识别（--digits）使用 2025-C-NumberSquare 中的 SquareNet 推理代码
+NUMBER_SQUARE_SRC="../2025-C-NumberSquare/src"
+NUMBER_SQUARE_FILES="$NUMBER_SQUARE_SRC/square_net.cpp $NUMBER_SQUARE_SRC/gemm.cpp $NUMBER_SQUARE_SRC/worker_pool.cpp $NUMBER_SQUARE_SRC/weights_file.cpp"
+
 # 设置头文件搜索路径
-INCLUDES="-I./include -I/usr/include/opencv4"
+INCLUDES="-I./include -I$NUMBER_SQUARE_SRC -I/usr/include/opencv4"
 
 # 设置库文件搜索路径和链接选项
 LIBS="-lopencv_core -lopencv_imgproc -lopencv_highgui -lopencv_videoio -lopencv_imgcodecs -pthread"
 
-# 查找源文件
+# 查找源文件（基准测试与主程序共用除 main.cpp 以外的源文件）
 SRC_FILES="src/*.cpp"
+LIB_FILES=$(ls src/*.cpp | grep -v "src/main.cpp")
+BENCH_FILES="bench/bench_square.cpp"
 
 # 输出可执行文件名称
 OUTPUT="square_detection"
+BENCH_OUTPUT="bench_square"
 
 # 创建构建目录
 mkdir -p build
-cd build
 
 # 编译命令
-$CXX $CXXFLAGS $INCLUDES $SRC_FILES -o $OUTPUT $LIBS
+$CXX $CXXFLAGS $INCLUDES $SRC_FILES $NUMBER_SQUARE_FILES -o build/$OUTPUT $LIBS
 
 # 检查编译是否成功
 if [ $? -eq 0 ]; then
@@ -34,4 +40,14 @@ if [ $? -eq 0 ]; then
 else
     echo "编译失败!"
     exit 1
+fi
+
+# 编译基准测试程序
+$CXX $CXXFLAGS $INCLUDES $LIB_FILES $NUMBER_SQUARE_FILES $BENCH_FILES -o build/$BENCH_OUTPUT $LIBS
+
+if [ $? -eq 0 ]; then
+    echo "编译成功! 基准测试: build/$BENCH_OUTPUT <图片目录或视频> [--json 结果.json]"
+else
+    echo "基准测试编译失败!"
+    exit 1
 fi
\ No newline at end of file
@@ -0,0 +1,99 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <cstddef>
+
+/**
+ * 有界阻塞队列
+ * 用于流水线各阶段之间传递数据，队列满时生产者阻塞，形成背压
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * 构造函数
+     * @param capacity 队列容量
+     */
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity > 0 ? capacity : 1), closed_(false) {}
+
+    /**
+     * 放入元素，队列满时阻塞
+     * @param item 要放入的元素
+     * @return 队列已关闭时返回false
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_full_.wait(lock, [this]() { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * 尝试放入元素，队列满时立即返回
+     * @param item 要放入的元素
+     * @return 是否放入成功
+     */
+    bool tryPush(T item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_ || items_.size() >= capacity_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * 取出元素，队列空时阻塞
+     * @param item 取出的元素
+     * @return 队列已关闭且为空时返回false
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this]() { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /**
+     * 关闭队列，唤醒所有等待的线程
+     * 关闭后不能再放入，但可以取完剩余元素
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /**
+     * 获取当前元素数量
+     * @return 元素数量
+     */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+private:
+    std::deque<T> items_; // 元素存储
+    size_t capacity_; // 队列容量
+    bool closed_; // 是否已关闭
+    mutable std::mutex mutex_; // 互斥锁
+    std::condition_variable not_empty_; // 非空条件
+    std::condition_variable not_full_; // 非满条件
+};
+
+#endif // BOUNDED_QUEUE_H
@@ -0,0 +1,137 @@
+#ifndef CAPTURE_BACKEND_H
+#define CAPTURE_BACKEND_H
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * 采集帧的像素格式
+ */
+enum class PixelFormat {
+    BGR,  // 3通道 BGR
+    GRAY, // 单通道灰度
+    YUYV, // 打包 YUV 4:2:2，CV_8UC2
+    NV12  // 平面 Y + 交错 UV，CV_8UC1，高度为图像高度的1.5倍
+};
+
+/**
+ * 采集后端输出的一帧
+ */
+struct CaptureFrame {
+    cv::Mat image; // 图像数据，可能直接引用后端持有的缓冲区
+    PixelFormat format; // 像素格式
+    uint64_t sequence; // 帧序号
+    int64_t timestamp_us; // 采集时间戳（微秒）
+    bool read_only; // image 是否引用后端持有的缓冲区（只读，不能修改）
+    std::shared_ptr<void> lease; // 缓冲区租约，最后一个引用释放时缓冲区归还给后端
+
+    CaptureFrame() : format(PixelFormat::BGR), sequence(0), timestamp_us(0), read_only(false) {}
+};
+
+/**
+ * 采集后端接口
+ * 统一摄像头、V4L2 驱动和录像回放等数据来源
+ */
+class CaptureBackend {
+public:
+    virtual ~CaptureBackend() {}
+
+    /**
+     * 打开设备
+     * @return 是否打开成功
+     */
+    virtual bool open() = 0;
+
+    /**
+     * 获取一帧图像
+     * @param frame 输出帧，持有 frame.lease 期间对应缓冲区不会被复用
+     * @return 是否获取成功
+     */
+    virtual bool grab(CaptureFrame& frame) = 0;
+
+    /**
+     * 关闭设备
+     */
+    virtual void close() = 0;
+
+    /**
+     * 检查设备是否打开
+     * @return 是否打开
+     */
+    virtual bool isOpened() const = 0;
+};
+
+/**
+ * 基于 cv::VideoCapture 的采集后端
+ * 每帧解码并拷贝为 BGR 图像
+ */
+class OpenCvCapture : public CaptureBackend {
+public:
+    /**
+     * 构造函数
+     * @param camera_id 摄像头ID
+     */
+    explicit OpenCvCapture(int camera_id);
+
+    bool open() override;
+    bool grab(CaptureFrame& frame) override;
+    void close() override;
+    bool isOpened() const override;
+
+private:
+    int camera_id_; // 摄像头ID
+    cv::VideoCapture camera_; // 摄像头捕获对象
+    uint64_t sequence_; // 帧序号
+};
+
+/**
+ * 录像回放采集后端
+ * 从图片目录或视频文件读取帧，用于没有摄像头的机器上测试整条处理链路
+ * 图片目录在打开时全部载入内存，回放期间不产生磁盘读取和解码
+ */
+class ReplayCapture : public CaptureBackend {
+public:
+    /**
+     * 构造函数
+     * @param path 图片目录或视频文件路径
+     * @param loop 播放完毕后是否从头循环
+     * @param fps 回放帧率，0表示不限速
+     * @param format 输出格式（BGR 或 GRAY），GRAY 用于模拟只输出亮度的摄像头
+     */
+    ReplayCapture(const std::string& path, bool loop = true, double fps = 0, PixelFormat format = PixelFormat::BGR);
+
+    bool open() override;
+    bool grab(CaptureFrame& frame) override;
+    void close() override;
+    bool isOpened() const override;
+
+    /**
+     * 获取已载入的帧数（视频文件返回0）
+     * @return 帧数
+     */
+    size_t frameCount() const;
+
+private:
+    std::string path_; // 数据路径
+    bool loop_; // 是否循环
+    double fps_; // 回放帧率
+    PixelFormat format_; // 输出格式
+    bool is_open_; // 是否打开
+    std::vector<cv::Mat> frames_; // 已载入的图片
+    size_t next_index_; // 下一帧下标
+    cv::VideoCapture video_; // 视频文件读取对象
+    uint64_t sequence_; // 帧序号
+    std::chrono::steady_clock::time_point next_time_; // 下一帧的交付时间
+};
+
+/**
+ * 获取当前单调时钟时间（微秒）
+ * @return 时间戳
+ */
+int64_t captureNowMicros();
+
+#endif // CAPTURE_BACKEND_H
@@ -0,0 +1,131 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include "frame_pipeline.h"
+
+/**
+ * 飞行记录仪
+ * 在内存环形缓冲区中保存最近若干帧的原始图像、结果图像和识别结果；
+ * 触发（信号、外部命令、异常检测）后再记录少量后续帧，然后把整个缓冲区交给后台线程编码写盘
+ * 记录路径只保存图像引用，不拷贝、不编码、不做磁盘 I/O；
+ * 环形缓冲区成对预分配，写盘期间记录继续写入另一块缓冲区
+ */
+class FlightRecorder {
+public:
+    /**
+     * 构造函数
+     * @param output_dir 输出目录，每次触发在其中创建一个子目录
+     * @param capacity 保存的帧数
+     * @param post_trigger_frames 触发后继续记录的帧数
+     */
+    FlightRecorder(const std::string& output_dir, size_t capacity, size_t post_trigger_frames = 0);
+
+    /**
+     * 析构函数
+     * 等待正在进行的写盘完成
+     */
+    ~FlightRecorder();
+
+    /**
+     * 启动后台写盘线程
+     * @return 输出目录是否可用
+     */
+    bool start();
+
+    /**
+     * 停止后台写盘线程
+     */
+    void stop();
+
+    /**
+     * 记录一帧，只在一个线程中调用
+     * 保存的图像与 packet 共享数据，调用后不能再修改 packet 中的图像
+     * @param packet 流水线输出的一帧
+     */
+    void record(const FramePacket& packet);
+
+    /**
+     * 触发一次保存，可在任意线程中调用
+     * 再记录 post_trigger_frames 帧后把缓冲区交给后台线程；上一次写盘尚未完成时忽略本次触发
+     * @param reason 触发原因，用于输出目录命名
+     */
+    void trigger(const std::string& reason);
+
+    /**
+     * 请求触发一次保存（原因为 signal）
+     * 只设置原子标志，在下一次 record 时生效，可以在信号处理函数中调用
+     */
+    static void requestTrigger();
+
+    /**
+     * 获取已完成的保存次数
+     * @return 保存次数
+     */
+    uint64_t dumpsWritten() const;
+
+    /**
+     * 获取因上一次写盘未完成而被忽略的触发次数
+     * @return 忽略次数
+     */
+    uint64_t triggersSkipped() const;
+
+private:
+    // 缓冲区中的一帧
+    struct Entry {
+        uint64_t sequence; // 帧序号
+        int64_t capture_us; // 采集完成时间
+        cv::Mat frame; // 原始图像
+        cv::Mat result_image; // 结果图像
+        std::vector<cv::Point2f> min_square; // 最小正方形的顶点
+
+        Entry() : sequence(0), capture_us(0) {}
+    };
+
+    // 交给后台线程的一次保存
+    struct Dump {
+        std::vector<Entry> entries; // 环形缓冲区
+        size_t first; // 最早一帧的下标
+        size_t count; // 有效帧数
+        std::string reason; // 触发原因
+
+        Dump() : first(0), count(0) {}
+    };
+
+    // 后台写盘线程函数
+    void writerThread();
+
+    // 把一次保存写入磁盘
+    bool writeDump(const Dump& dump);
+
+    std::string output_dir_; // 输出目录
+    size_t capacity_; // 保存的帧数
+    size_t post_trigger_frames_; // 触发后继续记录的帧数
+
+    std::vector<Entry> ring_; // 当前记录的环形缓冲区
+    size_t head_; // 下一帧写入的下标
+    size_t count_; // 有效帧数
+
+    std::mutex mutex_; // 保护触发状态和两块缓冲区的交换
+    std::condition_variable dump_ready_; // 有待写盘的数据或停止
+    Dump dump_; // 待写盘/正在写盘的数据，空闲时持有备用缓冲区
+    bool dump_busy_; // dump_ 是否正被后台线程使用
+    bool triggered_; // 是否已触发、正在记录后续帧
+    size_t post_remaining_; // 触发后还需记录的帧数
+    std::string trigger_reason_; // 本次触发的原因
+    bool stop_; // 是否停止
+    std::thread writer_thread_; // 后台写盘线程
+
+    std::atomic<uint64_t> dumps_written_; // 已完成的保存次数
+    std::atomic<uint64_t> triggers_skipped_; // 被忽略的触发次数
+    static std::atomic<bool> signal_requested_; // 信号请求的触发
+};
+
+#endif // FLIGHT_RECORDER_H
@@ -0,0 +1,97 @@
+#ifndef FRAME_MAILBOX_H
+#define FRAME_MAILBOX_H
+
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * 只保存最新一个元素的信箱
+ * 与 BoundedQueue 不同，发布方从不阻塞：上一个元素还未被取走时直接覆盖并计为丢弃，
+ * 用于预览等可以丢帧、但不能反压上游的输出端
+ */
+template <typename T>
+class FrameMailbox {
+public:
+    /**
+     * 构造函数
+     */
+    FrameMailbox() : has_value_(false), closed_(false), dropped_(0) {}
+
+    /**
+     * 放入新元素，覆盖尚未取走的旧元素
+     * @param value 新元素
+     * @return 是否覆盖了旧元素
+     */
+    bool put(T value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool replaced = has_value_;
+        if (replaced) {
+            ++dropped_;
+        }
+        value_ = std::move(value);
+        has_value_ = true;
+        not_empty_.notify_one();
+        return replaced;
+    }
+
+    /**
+     * 取出最新元素
+     * @param value 输出元素
+     * @param timeout_ms 最长等待时间（毫秒），负数表示一直等待
+     * @return 超时或信箱已关闭且为空时返回false
+     */
+    bool take(T& value, int timeout_ms = -1) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (timeout_ms < 0) {
+            not_empty_.wait(lock, [this]() { return has_value_ || closed_; });
+        } else {
+            not_empty_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
+                                [this]() { return has_value_ || closed_; });
+        }
+        if (!has_value_) {
+            return false;
+        }
+        value = std::move(value_);
+        value_ = T();
+        has_value_ = false;
+        return true;
+    }
+
+    /**
+     * 关闭信箱，唤醒所有等待的线程
+     */
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        not_empty_.notify_all();
+    }
+
+    /**
+     * 重新打开已关闭的信箱
+     */
+    void reopen() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = false;
+    }
+
+    /**
+     * 获取被覆盖丢弃的元素数量
+     * @return 丢弃数量
+     */
+    uint64_t dropped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+private:
+    T value_; // 最新元素
+    bool has_value_; // 是否有未取走的元素
+    bool closed_; // 是否已关闭
+    uint64_t dropped_; // 被覆盖丢弃的元素数量
+    mutable std::mutex mutex_; // 互斥锁
+    std::condition_variable not_empty_; // 有新元素或已关闭
+};
+
+#endif // FRAME_MAILBOX_H
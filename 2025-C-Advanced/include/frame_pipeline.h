@@ -0,0 +1,134 @@
+#ifndef FRAME_PIPELINE_H
+#define FRAME_PIPELINE_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include "bounded_queue.h"
+#include "latency_stats.h"
+#include "square_classifier.h"
+
+/**
+ * 流水线中流转的一帧数据
+ */
+struct FramePacket {
+    uint64_t sequence; // 帧序号（从0开始递增）
+    cv::Mat frame; // 原始图像
+    cv::Mat result_image; // 识别结果图像
+    std::vector<cv::Point2f> min_square; // 最小正方形的顶点
+    std::vector<SquareDigit> digits; // 各正方形及其数字（设置了 setRecognizer 时输出）
+    int64_t capture_us; // 采集完成时间（微秒，captureNowMicros 时钟）
+    int64_t detect_end_us; // 识别完成时间（微秒）
+
+    FramePacket() : sequence(0), capture_us(0), detect_end_us(0) {}
+};
+
+/**
+ * 采集 -> 识别 -> 输出 三级流水线
+ * 采集线程不断取帧，N个识别线程并行处理，输出端按帧序号重新排序后交付，
+ * 各阶段之间使用有界队列连接，保证第N+1帧采集时第N帧正在识别
+ */
+class FramePipeline {
+public:
+    /**
+     * 采集函数：将新的一帧写入frame，失败返回false（流水线随之结束）
+     * 每次调用都应写入独立的图像缓冲区，不能复用上一帧的数据
+     */
+    typedef std::function<bool(cv::Mat& frame)> CaptureFunc;
+
+    /**
+     * 识别函数：与 shibie_Square_min 签名一致
+     */
+    typedef std::function<void(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square)> DetectFunc;
+
+    /**
+     * 识别函数：在 DetectFunc 的基础上输出各正方形及其数字，与 SquareClassifier::process 签名一致
+     */
+    typedef std::function<void(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square,
+                               std::vector<SquareDigit>& digits)> RecognizeFunc;
+
+    /**
+     * 构造函数
+     * @param capture 采集函数
+     * @param detect 识别函数
+     * @param num_workers 识别线程数量
+     * @param queue_capacity 每个队列的容量（同时也是乱序缓冲区的容量）
+     */
+    FramePipeline(CaptureFunc capture, DetectFunc detect, size_t num_workers, size_t queue_capacity = 4);
+
+    /**
+     * 析构函数
+     */
+    ~FramePipeline();
+
+    /**
+     * 设置延迟统计，必须在 start 之前调用
+     * 记录 capture_us（采集耗时）、queue_wait_us（排队等待）、detect_us（识别耗时）
+     * 和 input_queue_depth（采集时的队列深度）
+     * @param stats 统计中心，为空时不记录
+     */
+    void setStats(LatencyStats* stats);
+
+    /**
+     * 设置带数字识别的识别函数，代替构造时传入的识别函数，必须在 start 之前调用
+     * @param recognize 识别函数，为空时使用构造时的识别函数
+     */
+    void setRecognizer(RecognizeFunc recognize);
+
+    /**
+     * 启动采集和识别线程
+     */
+    void start();
+
+    /**
+     * 停止流水线并等待所有线程退出
+     */
+    void stop();
+
+    /**
+     * 按帧序号顺序取出下一帧的识别结果，阻塞直到结果就绪
+     * @param packet 输出的帧数据
+     * @return 流水线已结束且没有剩余结果时返回false
+     */
+    bool nextResult(FramePacket& packet);
+
+private:
+    // 采集线程函数
+    void captureThread();
+
+    // 识别线程函数
+    void workerThread();
+
+    CaptureFunc capture_; // 采集函数
+    DetectFunc detect_; // 识别函数
+    RecognizeFunc recognize_; // 带数字识别的识别函数，非空时代替 detect_
+    size_t num_workers_; // 识别线程数量
+    size_t reorder_capacity_; // 乱序缓冲区容量
+
+    BoundedQueue<FramePacket> input_queue_; // 采集 -> 识别 队列
+    std::thread capture_thread_; // 采集线程
+    std::vector<std::thread> workers_; // 识别线程
+
+    std::map<uint64_t, FramePacket> reorder_buffer_; // 已完成但尚未按序交付的帧
+    uint64_t next_sequence_; // 下一个应交付的帧序号
+    size_t active_workers_; // 仍在运行的识别线程数
+    std::mutex reorder_mutex_; // 乱序缓冲区互斥锁
+    std::condition_variable result_ready_; // 有新结果或流水线结束
+    std::condition_variable reorder_space_; // 乱序缓冲区有空位
+
+    LatencyHistogram* capture_hist_; // 采集耗时
+    LatencyHistogram* queue_wait_hist_; // 排队等待时间
+    LatencyHistogram* detect_hist_; // 识别耗时
+    LatencyHistogram* queue_depth_hist_; // 采集时的队列深度
+
+    std::atomic<bool> stop_; // 是否停止
+    bool started_; // 是否已启动
+};
+
+#endif // FRAME_PIPELINE_H
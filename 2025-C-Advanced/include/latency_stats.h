@@ -0,0 +1,189 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <ostream>
+
+/**
+ * 直方图快照
+ */
+struct HistogramSnapshot {
+    std::string name; // 直方图名称
+    uint64_t count; // 样本数
+    uint64_t min; // 最小值
+    uint64_t max; // 最大值
+    double mean; // 平均值
+    std::vector<uint64_t> buckets; // 各桶的样本数
+
+    HistogramSnapshot() : count(0), min(0), max(0), mean(0) {}
+
+    /**
+     * 计算百分位数
+     * @param q 百分位（0~1），如 0.99
+     * @return 对应桶的中点值，相对误差不超过约3%
+     */
+    uint64_t percentile(double q) const;
+};
+
+/**
+ * 对数-线性分桶的无锁直方图（HDR 风格）
+ * 小于32的值每个值一个桶，更大的值每个2的幂区间均分为16个桶，
+ * 覆盖 0 ~ 2^64 的范围，相对误差约3%
+ * 每个线程写入自己的分片，记录只需几次无竞争的原子操作，快照时合并所有分片
+ */
+class LatencyHistogram {
+public:
+    static const size_t kBucketCount = 976; // 桶数量
+    static const size_t kShardCount = 8; // 分片数量，超过该数量的线程会共享分片
+
+    /**
+     * 构造函数
+     * @param name 直方图名称
+     */
+    explicit LatencyHistogram(const std::string& name);
+
+    /**
+     * 记录一个样本，可在任意线程中调用
+     * @param value 样本值（通常为微秒）
+     */
+    void record(uint64_t value);
+
+    /**
+     * 获取快照，不阻塞正在记录的线程
+     * @return 合并所有分片后的快照
+     */
+    HistogramSnapshot snapshot() const;
+
+    /**
+     * 清空所有样本
+     * 与 record 并发调用时，正在记录的样本可能被部分清除
+     */
+    void reset();
+
+    /**
+     * 获取直方图名称
+     * @return 名称
+     */
+    const std::string& name() const;
+
+    /**
+     * 计算样本值所在的桶
+     * @param value 样本值
+     * @return 桶下标
+     */
+    static size_t bucketIndex(uint64_t value);
+
+    /**
+     * 计算桶的下界（含）
+     * @param index 桶下标
+     * @return 下界
+     */
+    static uint64_t bucketLowerBound(size_t index);
+
+    /**
+     * 计算桶的上界（含）
+     * @param index 桶下标
+     * @return 上界
+     */
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    // 一个线程分片，末尾填充避免与相邻分片共享缓存行
+    struct Shard {
+        std::atomic<uint64_t> buckets[kBucketCount];
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> sum;
+        std::atomic<uint64_t> min;
+        std::atomic<uint64_t> max;
+        char padding[64];
+    };
+
+    std::string name_; // 直方图名称
+    std::unique_ptr<Shard[]> shards_; // 线程分片
+};
+
+/**
+ * 延迟统计中心
+ * 统一管理各阶段的直方图和计数器，支持随时获取快照以及后台定期输出
+ * histogram/counter 应在启动阶段注册，返回的引用在对象生命周期内有效，热路径只使用引用
+ */
+class LatencyStats {
+public:
+    /**
+     * 构造函数
+     */
+    LatencyStats();
+
+    /**
+     * 析构函数
+     * 停止后台输出线程
+     */
+    ~LatencyStats();
+
+    /**
+     * 获取（不存在时创建）指定名称的直方图
+     * @param name 名称，建议以单位结尾，如 detect_us
+     * @return 直方图引用
+     */
+    LatencyHistogram& histogram(const std::string& name);
+
+    /**
+     * 获取（不存在时创建）指定名称的计数器
+     * @param name 名称
+     * @return 计数器引用
+     */
+    std::atomic<uint64_t>& counter(const std::string& name);
+
+    /**
+     * 获取所有直方图的快照
+     * @return 快照列表（按注册顺序）
+     */
+    std::vector<HistogramSnapshot> snapshot() const;
+
+    /**
+     * 输出所有直方图的 p50/p99/p999 和所有计数器
+     * @param out 输出流
+     */
+    void report(std::ostream& out) const;
+
+    /**
+     * 启动后台线程定期输出统计信息到标准输出
+     * @param interval_s 输出间隔（秒），0表示只在 requestDump 时输出
+     */
+    void startPeriodicDump(double interval_s);
+
+    /**
+     * 停止后台输出线程
+     */
+    void stopPeriodicDump();
+
+    /**
+     * 请求后台线程立即输出一次统计信息
+     * 只设置原子标志，可以在信号处理函数中调用
+     */
+    static void requestDump();
+
+private:
+    // 后台输出线程函数
+    void dumpThread(double interval_s);
+
+    mutable std::mutex mutex_; // 保护注册表
+    std::vector<std::unique_ptr<LatencyHistogram>> histograms_; // 已注册的直方图
+    std::vector<std::string> counter_names_; // 已注册的计数器名称
+    std::vector<std::unique_ptr<std::atomic<uint64_t>>> counters_; // 已注册的计数器
+
+    std::thread dump_thread_; // 后台输出线程
+    std::mutex dump_mutex_; // 后台线程停止标志互斥锁
+    std::condition_variable dump_cv_; // 唤醒后台线程
+    bool dump_stop_; // 是否停止后台线程
+    static std::atomic<bool> dump_requested_; // 是否请求立即输出
+};
+
+#endif // LATENCY_STATS_H
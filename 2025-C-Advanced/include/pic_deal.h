@@ -2,11 +2,25 @@
 #define PIC_DEAL_H
 
 #include <opencv2/opencv.hpp>
+#include <memory>
 #include <vector>
+#include <cstdint>
+#include <atomic>
+#include "capture_backend.h"
+
+/**
+ * 采集模式
+ */
+enum class CaptureMode {
+    BGR, // 输出3通道 BGR 图像
+    LUMA // 直接输出亮度平面（单通道），YUV 来源不经过 BGR 转换
+};
 
 /**
  * 图像处理类
  * 负责图像的读取、预处理、特征提取等操作
+ * 灰度、模糊、边缘和二值化等中间结果按帧缓存，同一帧上多次调用不会重复计算；
+ * 读取新图像时缓存自动失效，通过 getCurrentImage 的引用原地修改图像后需调用 invalidateCache
  */
 class PicDeal {
 public:
@@ -34,6 +48,27 @@ public:
      */
     bool readFromCamera(int camera_id = 0);
 
+    /**
+     * 使用指定的采集后端读取图像（如 V4L2 mmap 或录像回放）
+     * @param backend 采集后端，PicDeal 接管其所有权
+     * @return 是否打开成功
+     */
+    bool openCapture(std::unique_ptr<CaptureBackend> backend);
+
+    /**
+     * 设置采集模式
+     * LUMA 模式下 getCurrentImage/readFrame 返回单通道亮度图像，
+     * YUYV 来源使用 SIMD 提取亮度，NV12/GRAY 来源直接取 Y 平面
+     * @param mode 采集模式
+     */
+    void setCaptureMode(CaptureMode mode);
+
+    /**
+     * 获取采集模式
+     * @return 采集模式
+     */
+    CaptureMode getCaptureMode() const;
+
     /**
      * 保存图像
      * @param img_path 保存路径
@@ -43,25 +78,60 @@ public:
 
     /**
      * 图像灰度化
+     * 当前图像已是单通道时直接返回，不做转换
+     * 返回的图像与内部缓存共享数据，不要原地修改
      * @return 处理后的灰度图像
      */
     cv::Mat toGrayscale();
 
+    /**
+     * 图像灰度化，结果写入调用者提供的缓冲区
+     * 缓冲区尺寸和类型不变时复用其内存，不产生堆分配
+     * @param gray 输出灰度图像
+     * @return 是否处理成功
+     */
+    bool toGrayscale(cv::Mat& gray);
+
     /**
      * 图像二值化
+     * 返回的图像与内部缓存共享数据，不要原地修改
      * @param threshold 阈值
      * @return 处理后的二值图像
      */
     cv::Mat binarize(int threshold);
 
+    /**
+     * 图像二值化，结果写入调用者提供的缓冲区
+     * @param threshold 阈值
+     * @param binary 输出二值图像
+     * @return 是否处理成功
+     */
+    bool binarize(int threshold, cv::Mat& binary);
+
     /**
      * 图像边缘检测
+     * 返回的图像与内部缓存共享数据，不要原地修改
      * @param low_threshold 低阈值
      * @param high_threshold 高阈值
      * @return 边缘检测后的图像
      */
     cv::Mat edgeDetection(int low_threshold, int high_threshold);
 
+    /**
+     * 图像边缘检测，结果写入调用者提供的缓冲区
+     * @param low_threshold 低阈值
+     * @param high_threshold 高阈值
+     * @param edges 输出边缘图像
+     * @return 是否处理成功
+     */
+    bool edgeDetection(int low_threshold, int high_threshold, cv::Mat& edges);
+
+    /**
+     * 使缓存的中间结果失效
+     * 通过 getCurrentImage 返回的引用修改了图像内容后调用
+     */
+    void invalidateCache();
+
     /**
      * 查找轮廓
      * @param contours 轮廓容器
@@ -76,10 +146,68 @@ public:
      */
     cv::Mat& getCurrentImage();
 
+    /**
+     * 从摄像头读取新的一帧到调用者提供的图像中
+     * 与 getCurrentImage 不同，每帧使用独立的缓冲区，适合交给其他线程处理
+     * @param frame 输出图像
+     * @return 是否读取成功
+     */
+    bool readFrame(cv::Mat& frame);
+
+    /**
+     * 从采集后端获取原始帧，不做颜色转换和拷贝
+     * 持有 frame.lease 期间对应的驱动缓冲区不会被复用
+     * @param frame 输出帧
+     * @return 是否获取成功
+     */
+    bool grabFrame(CaptureFrame& frame);
+
+    /**
+     * 获取 readFrame 发现的丢帧数
+     * 根据采集后端给出的帧序号是否连续判断（V4L2 为驱动帧序号），可以在其他线程中调用
+     * @return 累计丢帧数
+     */
+    uint64_t droppedFrames() const;
+
 private:
+    // 按帧缓存的中间结果，各阶段记录计算时的图像代数，与 generation_ 相同时有效
+    struct StageCache {
+        uint64_t gray_generation; // 灰度图对应的图像代数
+        cv::Mat gray; // 灰度图
+        uint64_t blurred_generation; // 模糊图对应的图像代数
+        cv::Mat blurred; // 3x3 高斯模糊后的灰度图
+        uint64_t edges_generation; // 边缘图对应的图像代数
+        int edges_low; // 边缘图的低阈值
+        int edges_high; // 边缘图的高阈值
+        cv::Mat edges; // 边缘图
+        uint64_t binary_generation; // 二值图对应的图像代数
+        int binary_threshold; // 二值图的阈值
+        cv::Mat binary; // 二值图
+
+        StageCache()
+            : gray_generation(0), blurred_generation(0), edges_generation(0), edges_low(0), edges_high(0),
+              binary_generation(0), binary_threshold(0) {}
+    };
+
+    // 检查当前图像是否被替换，是则推进图像代数
+    void syncGeneration();
+
+    // 获取各阶段的缓存结果，过期时重新计算；调用前需确保当前图像非空
+    const cv::Mat& cachedGray();
+    const cv::Mat& cachedBlurred();
+    const cv::Mat& cachedEdges(int low_threshold, int high_threshold);
+    const cv::Mat& cachedBinary(int threshold);
+
     cv::Mat current_image_; // 当前处理的图像
-    cv::VideoCapture camera_; // 摄像头捕获对象
+    uint64_t generation_; // 图像代数，当前图像每变化一次加一
+    const uchar* source_data_; // 当前代数对应的图像数据地址，用于发现通过引用整体替换的图像
+    StageCache cache_; // 中间结果缓存
+    std::unique_ptr<CaptureBackend> capture_; // 采集后端
     bool is_camera_open_; // 摄像头是否打开
+    CaptureMode capture_mode_; // 采集模式
+    bool has_last_sequence_; // 是否已读取过帧
+    uint64_t last_sequence_; // 上一帧的序号
+    std::atomic<uint64_t> dropped_frames_; // 累计丢帧数
 };
 
 #endif // PIC_DEAL_H
\ No newline at end of file
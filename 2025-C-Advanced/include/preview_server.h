@@ -0,0 +1,108 @@
+#ifndef PREVIEW_SERVER_H
+#define PREVIEW_SERVER_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include "frame_mailbox.h"
+
+/**
+ * MJPEG 预览服务器
+ * 通过 HTTP（multipart/x-mixed-replace）向浏览器推送标注后的结果图像，用于无显示器的设备
+ * publish 只把图像放入信箱并立即返回；编码线程只编码最新一帧，
+ * 每个客户端线程只发送最新的编码结果，慢客户端只会少收帧，不会反压识别流程
+ */
+class PreviewServer {
+public:
+    /**
+     * 构造函数
+     * @param port 监听端口
+     * @param jpeg_quality JPEG 质量（0~100）
+     * @param bind_address 监听地址，默认只允许本机访问
+     */
+    explicit PreviewServer(int port = 8080, int jpeg_quality = 80, const std::string& bind_address = "127.0.0.1");
+
+    /**
+     * 析构函数
+     */
+    ~PreviewServer();
+
+    /**
+     * 开始监听并启动编码线程
+     * @return 是否启动成功
+     */
+    bool start();
+
+    /**
+     * 停止服务，断开所有客户端
+     */
+    void stop();
+
+    /**
+     * 发布一帧图像，从不阻塞
+     * 图像数据被共享而不是拷贝，发布后调用者不能再修改该图像
+     * @param image 待预览的 BGR 图像
+     */
+    void publish(const cv::Mat& image);
+
+    /**
+     * 获取未被编码就被新帧覆盖的帧数
+     * @return 丢帧数
+     */
+    uint64_t droppedFrames() const;
+
+    /**
+     * 获取当前连接的客户端数量
+     * @return 客户端数量
+     */
+    size_t clientCount() const;
+
+private:
+    // 一个已连接的客户端
+    struct Client {
+        int fd; // 套接字
+        std::thread thread; // 发送线程
+        std::atomic<bool> finished; // 发送线程是否已退出
+
+        Client() : fd(-1), finished(false) {}
+    };
+
+    // 监听线程函数
+    void acceptThread();
+
+    // 编码线程函数
+    void encodeThread();
+
+    // 客户端线程函数
+    void clientThread(Client* client);
+
+    // 回收已断开的客户端
+    void reapClients();
+
+    // 发送全部数据，失败返回false
+    static bool sendAll(int fd, const void* data, size_t size);
+
+    int port_; // 监听端口
+    int jpeg_quality_; // JPEG 质量
+    std::string bind_address_; // 监听地址
+    int listen_fd_; // 监听套接字
+    std::atomic<bool> running_; // 是否运行中
+
+    FrameMailbox<cv::Mat> pending_; // 等待编码的最新一帧
+    std::thread accept_thread_; // 监听线程
+    std::thread encode_thread_; // 编码线程
+
+    mutable std::mutex clients_mutex_; // 保护客户端列表和编码结果
+    std::condition_variable jpeg_ready_; // 有新的编码结果或服务停止
+    std::shared_ptr<const std::vector<uchar>> latest_jpeg_; // 最新的编码结果
+    uint64_t jpeg_generation_; // 编码结果序号
+    std::vector<std::unique_ptr<Client>> clients_; // 已连接的客户端
+};
+
+#endif // PREVIEW_SERVER_H
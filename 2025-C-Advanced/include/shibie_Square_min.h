@@ -0,0 +1,142 @@
+#ifndef SHIBIE_SQUARE_MIN_H
+#define SHIBIE_SQUARE_MIN_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * 正方形识别参数
+ */
+struct SquareDetectOptions {
+    int pyramid_levels; // 在第几层金字塔上检测，0为原图，1为1/2，2为1/4
+    bool refine_corners; // 是否在原图上对四个顶点做亚像素精化
+    ThreadPool* pool; // 分块并行检测使用的线程池，为空时单线程检测
+    int tile_size; // 分块边长（原图像素），0表示不分块
+    int tile_overlap; // 分块向四周扩展的宽度（原图像素），更大的正方形（包围盒约超过它的两倍）由降采样的整幅图像检测
+
+    SquareDetectOptions() : pyramid_levels(0), refine_corners(false), pool(nullptr), tile_size(0), tile_overlap(128) {}
+};
+
+/**
+ * 识别图像中的正方形，处理重叠情况，并找出最小的正方形
+ * @param image 输入图像（BGR 或单通道灰度）
+ * @param result_image 输出结果图像
+ * @param min_square 输出最小正方形的顶点
+ */
+void shibie_Square_min(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square);
+
+/**
+ * 由粗到精识别正方形：在降采样的金字塔层上检测，再回到原图精化顶点
+ * @param image 输入图像（BGR 或单通道灰度）
+ * @param result_image 输出结果图像
+ * @param min_square 输出最小正方形的顶点
+ * @param options 识别参数
+ */
+void shibie_Square_min(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square,
+                       const SquareDetectOptions& options);
+
+/**
+ * 识别图像中所有不重叠的正方形，即 shibie_Square_min 去掉选取最小正方形和绘制的部分
+ * @param image 输入图像（BGR 或单通道灰度）
+ * @param squares 输出不重叠的正方形顶点
+ * @param options 识别参数
+ * @param areas 可选，输出与 squares 一一对应的面积
+ * @param candidates 可选，输出去除重叠前的全部候选（用于绘制）
+ */
+void detectSquares(const cv::Mat& image, std::vector<std::vector<cv::Point2f>>& squares,
+                   const SquareDetectOptions& options, std::vector<double>* areas = nullptr,
+                   std::vector<std::vector<cv::Point2f>>* candidates = nullptr);
+
+/**
+ * 在灰度图像中查找正方形候选（模糊 -> 边缘检测 -> 轮廓 -> 四边形拟合）
+ * @param gray 灰度图像，可以是大图中的一个 ROI
+ * @param squares 输出正方形顶点（追加到末尾）
+ * @param offset 顶点坐标偏移，传入 ROI 左上角即可得到整幅图像中的坐标
+ */
+void findSquareCandidates(const cv::Mat& gray, std::vector<std::vector<cv::Point2f>>& squares,
+                          cv::Point offset = cv::Point(0, 0));
+
+/**
+ * 对轮廓做多边形近似，保留近似为正方形的四边形
+ * @param contours 输入轮廓
+ * @param squares 输出正方形顶点（追加到末尾）
+ * @param offset 顶点坐标偏移
+ */
+void fitSquaresFromContours(const std::vector<std::vector<cv::Point>>& contours,
+                            std::vector<std::vector<cv::Point2f>>& squares, cv::Point offset = cv::Point(0, 0));
+
+/**
+ * 将图像切分为带重叠的分块，在线程池上并行查找正方形候选
+ * 接触分块内侧边界的四边形可能被截断，直接丢弃；
+ * 落在多个分块重叠区内的正方形只保留中心点所在分块的结果，因此不会重复
+ * 包围盒超过约 2*overlap 的正方形不能保证完整落在某一块内，改由与分块并行的一次降采样整幅图像检测得到，
+ * 其顶点精度为降采样倍率（可用 refineSquareCorners 精化）；尺寸在阈值附近、两边都检测到的正方形合并为一个
+ * @param gray 灰度图像
+ * @param squares 输出正方形顶点（追加到末尾，先按分块行优先顺序，最后是整幅图像检测到的大正方形）
+ * @param pool 线程池，调用线程也参与执行
+ * @param tile_size 分块边长（不含重叠部分）
+ * @param overlap 分块向四周扩展的宽度
+ */
+void findSquareCandidatesTiled(const cv::Mat& gray, std::vector<std::vector<cv::Point2f>>& squares, ThreadPool& pool,
+                               int tile_size, int overlap);
+
+/**
+ * 在金字塔的指定层上查找正方形候选，顶点坐标换算回原图
+ * 设置了线程池和分块大小时在该层上分块并行检测
+ * @param gray 原始分辨率的灰度图像
+ * @param squares 输出正方形顶点（追加到末尾）
+ * @param options 识别参数
+ * @return 实际使用的降采样倍率（图像过小时层数会减少）
+ */
+int findSquareCandidatesPyramid(const cv::Mat& gray, std::vector<std::vector<cv::Point2f>>& squares,
+                                const SquareDetectOptions& options);
+
+/**
+ * 在原图上用 cornerSubPix 精化正方形顶点
+ * 搜索窗口随正方形边长和金字塔倍率调整，精化后偏离过远的顶点保持原值
+ * @param gray 原始分辨率的灰度图像
+ * @param squares 待精化的正方形（原地修改）
+ * @param scale 顶点的原始定位精度（像素），金字塔第n层为2^n
+ */
+void refineSquareCorners(const cv::Mat& gray, std::vector<std::vector<cv::Point2f>>& squares, int scale = 1);
+
+/**
+ * 计算正方形的平均边长
+ * @param square 正方形顶点
+ * @return 四条边长的平均值（像素），顶点不足4个时返回0
+ */
+double squareEdgeLength(const std::vector<cv::Point2f>& square);
+
+/**
+ * 去除嵌套在更大正方形内部的正方形
+ * 使用包围盒均匀网格索引，只对可能包含的候选做精确检查，接近线性复杂度
+ * @param squares 输入正方形
+ * @param non_overlapping_squares 输出不重叠的正方形
+ * @param areas 可选，输出与 non_overlapping_squares 一一对应的面积
+ */
+void filterOverlappingSquares(const std::vector<std::vector<cv::Point2f>>& squares,
+                              std::vector<std::vector<cv::Point2f>>& non_overlapping_squares,
+                              std::vector<double>* areas = nullptr);
+
+/**
+ * 找出面积最小的正方形
+ * @param squares 输入正方形
+ * @param min_square 输出最小正方形的顶点
+ * @param areas 可选，与 squares 一一对应的面积，为空时重新计算
+ * @return 是否找到
+ */
+bool findMinSquare(const std::vector<std::vector<cv::Point2f>>& squares, std::vector<cv::Point2f>& min_square,
+                   const std::vector<double>* areas = nullptr);
+
+/**
+ * 在结果图像上绘制所有正方形（绿色）和最小正方形（红色）
+ * @param result_image 结果图像
+ * @param squares 所有正方形
+ * @param min_square 最小正方形的顶点，为空时不绘制
+ */
+void drawSquareResult(cv::Mat& result_image, const std::vector<std::vector<cv::Point2f>>& squares,
+                      const std::vector<cv::Point2f>& min_square);
+
+#endif // SHIBIE_SQUARE_MIN_H
@@ -0,0 +1,129 @@
+#ifndef SQUARE_CLASSIFIER_H
+#define SQUARE_CLASSIFIER_H
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "shibie_Square_min.h"
+#include "recognition_result.h"
+
+class SquareNet;
+
+/**
+ * 一个正方形及其中的数字
+ */
+struct SquareDigit {
+    std::vector<cv::Point2f> corners; // 顶点（左上、右上、右下、左下）
+    cv::Point2f center; // 中心点
+    double edge_length; // 平均边长（像素）
+    int digit; // 识别出的数字，识别失败为-1
+    float confidence; // 置信度（0~1）
+
+    SquareDigit() : edge_length(0), digit(-1), confidence(0) {}
+};
+
+/**
+ * 检测 -> 矫正 -> 分类 一体的识别阶段
+ * 检测与 shibie_Square_min 相同；每个不重叠的正方形按四个顶点直接透视变换到 128x128 的裁剪图
+ * （SquareNet 的输入尺寸），省去整帧缩放和写盘；一帧内所有裁剪图作为一个批次，
+ * 由 2025-C-NumberSquare 中的 SquareNet 在其线程池上并行预处理和推理
+ * 裁剪图缓冲区在帧间复用，图像类型不变时不再分配内存
+ * process 和 classify 内部加锁，多个线程调用时串行执行
+ */
+class SquareClassifier {
+public:
+    static const int kCropSize = 128; // 裁剪图边长
+
+    /**
+     * 构造函数
+     * @param options 正方形识别参数
+     * @param threads 推理线程数（含调用线程），0 表示使用全部硬件线程
+     */
+    explicit SquareClassifier(const SquareDetectOptions& options = SquareDetectOptions(), size_t threads = 0);
+
+    /**
+     * 析构函数
+     */
+    ~SquareClassifier();
+
+    /**
+     * 加载 SquareNet 权重（export_weights.py 或 quantize.py 导出的文件）
+     * @param path 权重文件路径
+     * @return 是否加载成功
+     */
+    bool loadWeights(const std::string& path);
+
+    /**
+     * 是否已加载权重
+     * @return 是否已加载
+     */
+    bool isLoaded() const;
+
+    /**
+     * 处理一帧：检测正方形并识别其中的数字
+     * min_square 和绘制内容与 shibie_Square_min 相同，另在每个正方形中心标注数字
+     * @param image 输入图像（BGR 或单通道灰度）
+     * @param result_image 输出结果图像
+     * @param min_square 输出最小正方形的顶点
+     * @param digits 输出所有不重叠的正方形及其数字
+     */
+    void process(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square,
+                 std::vector<SquareDigit>& digits);
+
+    /**
+     * 识别给定正方形中的数字（跳过检测）
+     * @param image 输入图像（BGR 或单通道灰度）
+     * @param squares 正方形顶点，顶点顺序任意
+     * @param digits 输出与 squares 一一对应的结果
+     * @return 是否识别成功，失败时各结果的 digit 为-1
+     */
+    bool classify(const cv::Mat& image, const std::vector<std::vector<cv::Point2f>>& squares,
+                  std::vector<SquareDigit>& digits);
+
+    /**
+     * 获取最近一次识别的裁剪图，用于调试
+     * 返回的图像在下一次识别时被覆盖
+     * @return 裁剪图，与最近一次的 digits 一一对应
+     */
+    std::vector<cv::Mat> lastCrops() const;
+
+    /**
+     * 当前使用的计算内核名称
+     * @return 内核名称，未加载权重时为空字符串
+     */
+    const char* kernelName() const;
+
+private:
+    // 矫正并分类，调用前需持有 mutex_
+    bool classifyLocked(const cv::Mat& image, const std::vector<std::vector<cv::Point2f>>& squares,
+                        std::vector<SquareDigit>& digits);
+
+    SquareDetectOptions options_; // 正方形识别参数
+    std::unique_ptr<SquareNet> net_; // 数字分类网络
+    std::vector<cv::Mat> crops_; // 裁剪图缓冲区（只增不减，前 crop_count_ 个有效）
+    size_t crop_count_; // 最近一次识别的裁剪图数量
+    std::vector<cv::Mat> batch_; // 传给 SquareNet 的批次（引用 crops_ 的前 crop_count_ 个）
+    std::vector<RecognitionResult> results_; // 分类结果
+    std::vector<std::vector<cv::Point2f>> squares_; // 不重叠的正方形
+    std::vector<std::vector<cv::Point2f>> candidates_; // 全部候选（用于绘制）
+    std::vector<double> areas_; // 不重叠正方形的面积
+    mutable std::mutex mutex_; // 保护网络和缓冲区
+};
+
+/**
+ * 将正方形顶点排列为左上、右上、右下、左下
+ * 以 x+y 最小的顶点为左上角，对旋转小于45度的正方形得到正向的裁剪图
+ * @param square 正方形顶点（原地修改），不足4个时不处理
+ */
+void orderSquareCorners(std::vector<cv::Point2f>& square);
+
+/**
+ * 在结果图像上标注每个正方形的数字和置信度
+ * @param result_image 结果图像
+ * @param digits 识别结果
+ */
+void drawSquareDigits(cv::Mat& result_image, const std::vector<SquareDigit>& digits);
+
+#endif // SQUARE_CLASSIFIER_H
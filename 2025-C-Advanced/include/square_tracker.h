@@ -0,0 +1,70 @@
+#ifndef SQUARE_TRACKER_H
+#define SQUARE_TRACKER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <mutex>
+
+/**
+ * 基于 ROI 跟踪的增量正方形识别
+ * 用匀速模型预测每个正方形在下一帧的位置，只在预测位置周围的 ROI 内做检测；
+ * 任何一个目标丢失，或距上次全图检测已满 full_detect_interval 帧时，退回全图检测
+ * 跟踪依赖帧的先后顺序，必须按帧序号依次调用 process
+ */
+class SquareTracker {
+public:
+    /**
+     * 构造函数
+     * @param full_detect_interval 两次全图检测之间的最大帧数
+     * @param roi_padding ROI 相对正方形边长的外扩比例
+     */
+    explicit SquareTracker(int full_detect_interval = 15, double roi_padding = 0.5);
+
+    /**
+     * 处理一帧，输出与 shibie_Square_min 相同
+     * @param image 输入图像（BGR 或单通道灰度）
+     * @param result_image 输出结果图像
+     * @param min_square 输出最小正方形的顶点
+     */
+    void process(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square);
+
+    /**
+     * 清空所有跟踪目标，下一帧做全图检测
+     */
+    void reset();
+
+    /**
+     * 获取累计的全图检测次数
+     * @return 全图检测次数
+     */
+    size_t fullDetections() const;
+
+    /**
+     * 获取累计的 ROI 检测次数
+     * @return ROI 检测次数
+     */
+    size_t roiDetections() const;
+
+private:
+    // 一个被跟踪的正方形
+    struct Track {
+        std::vector<cv::Point2f> corners; // 最近一次观测的顶点
+        cv::Point2f velocity; // 中心点速度（像素/帧）
+    };
+
+    // 全图检测，并用新结果重建跟踪目标
+    void detectFull(const cv::Mat& image, std::vector<std::vector<cv::Point2f>>& squares);
+
+    // 在预测位置附近的 ROI 中更新一个目标，失败返回false
+    bool updateTrack(const cv::Mat& image, Track& track, std::vector<std::vector<cv::Point2f>>& squares);
+
+    int full_detect_interval_; // 两次全图检测之间的最大帧数
+    double roi_padding_; // ROI 外扩比例
+    int frames_since_full_; // 距上次全图检测的帧数
+    std::vector<Track> tracks_; // 跟踪目标
+    size_t full_detections_; // 全图检测次数
+    size_t roi_detections_; // ROI 检测次数
+    mutable std::mutex mutex_; // 保护跟踪状态
+};
+
+#endif // SQUARE_TRACKER_H
@@ -5,13 +5,109 @@
 #include <mutex>
 #include <condition_variable>
 #include <functional>
-#include <queue>
+#include <future>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+
+/**
+ * 线程池任务
+ * 类型擦除的可调用对象，小于 kInlineSize 的任务直接存放在内部缓冲区中，不产生堆分配
+ * 只能移动构造的对象（如 std::packaged_task）也可以存放
+ */
+class PoolTask {
+public:
+    static const size_t kInlineSize = 48; // 内部缓冲区大小
+
+    PoolTask() : ops_(nullptr) {}
+    ~PoolTask() { reset(); }
+
+    /**
+     * 设置要执行的任务
+     * @param func 可调用对象
+     */
+    template <typename F>
+    void assign(F&& func) {
+        typedef typename std::decay<F>::type Fn;
+        reset();
+        assignImpl<Fn>(std::forward<F>(func),
+                       std::integral_constant<bool, sizeof(Fn) <= kInlineSize &&
+                                                    alignof(Fn) <= alignof(std::max_align_t)>());
+    }
+
+    /**
+     * 执行任务
+     */
+    void operator()() { ops_->invoke(&storage_); }
+
+    /**
+     * 销毁任务对象
+     */
+    void reset() {
+        if (ops_) {
+            ops_->destroy(&storage_);
+            ops_ = nullptr;
+        }
+    }
+
+private:
+    PoolTask(const PoolTask&);
+    PoolTask& operator=(const PoolTask&);
+
+    struct Ops {
+        void (*invoke)(void*);
+        void (*destroy)(void*);
+    };
+
+    // 存放在内部缓冲区中的任务
+    template <typename Fn>
+    struct InlineOps {
+        static void invoke(void* p) { (*static_cast<Fn*>(p))(); }
+        static void destroy(void* p) { static_cast<Fn*>(p)->~Fn(); }
+        static const Ops ops;
+    };
+
+    // 超出内部缓冲区大小、存放在堆上的任务
+    template <typename Fn>
+    struct HeapOps {
+        static void invoke(void* p) { (**static_cast<Fn**>(p))(); }
+        static void destroy(void* p) { delete *static_cast<Fn**>(p); }
+        static const Ops ops;
+    };
+
+    template <typename Fn, typename F>
+    void assignImpl(F&& func, std::true_type) {
+        new (&storage_) Fn(std::forward<F>(func));
+        ops_ = &InlineOps<Fn>::ops;
+    }
+
+    template <typename Fn, typename F>
+    void assignImpl(F&& func, std::false_type) {
+        *reinterpret_cast<Fn**>(&storage_) = new Fn(std::forward<F>(func));
+        ops_ = &HeapOps<Fn>::ops;
+    }
+
+    typename std::aligned_storage<kInlineSize, alignof(std::max_align_t)>::type storage_; // 任务存储
+    const Ops* ops_; // 任务操作表
+};
+
+template <typename Fn>
+const PoolTask::Ops PoolTask::InlineOps<Fn>::ops = { &PoolTask::InlineOps<Fn>::invoke, &PoolTask::InlineOps<Fn>::destroy };
+
+template <typename Fn>
+const PoolTask::Ops PoolTask::HeapOps<Fn>::ops = { &PoolTask::HeapOps<Fn>::invoke, &PoolTask::HeapOps<Fn>::destroy };
 
 /**
  * 线程池类
  * 提供多线程任务处理能力
+ * 每个工作线程拥有一个无锁双端队列（Chase-Lev），工作线程提交的任务压入自己的队列，
+ * 空闲线程从其他线程的队列尾部窃取任务；外部线程提交的任务进入共享的注入队列
  */
 class ThreadPool {
 public:
@@ -23,31 +119,206 @@ public:
 
     /**
      * 析构函数
+     * 等待已提交的任务执行完毕后退出工作线程
      */
     ~ThreadPool();
 
     /**
      * 添加任务到线程池
+     * 任务节点从空闲链表中复用，小任务不产生堆分配
+     * @param task 要执行的任务
+     */
+    template <typename F>
+    void enqueue(F&& task) {
+        TaskNode* node = acquireNode();
+        node->task.assign(std::forward<F>(task));
+        pushBatch(node, node, 1);
+    }
+
+    /**
+     * 提交任务并获取其结果
      * @param task 要执行的任务
+     * @return 保存任务返回值（或异常）的 future
+     */
+    template <typename F>
+    std::future<typename std::result_of<typename std::decay<F>::type()>::type> submit(F&& task) {
+        typedef typename std::result_of<typename std::decay<F>::type()>::type R;
+        std::packaged_task<R()> packaged(std::forward<F>(task));
+        std::future<R> result = packaged.get_future();
+        enqueue(std::move(packaged));
+        return result;
+    }
+
+    /**
+     * 并行执行区间 [begin, end)
+     * 区间被切分为若干块一次性批量提交，调用线程也参与执行，返回时所有块均已完成
+     * 某一块抛出异常时，尚未开始的块被跳过，等所有已提交的块结束后在调用线程重新抛出第一个异常
+     * @param begin 起始下标
+     * @param end 结束下标（不含）
+     * @param func 处理函数，签名为 void(size_t chunk_begin, size_t chunk_end)
+     * @param grain 每块的最小元素数
      */
-    void enqueue(std::function<void()> task);
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, F&& func, size_t grain = 1) {
+        if (begin >= end) {
+            return;
+        }
+        if (grain == 0) {
+            grain = 1;
+        }
+
+        // 计算分块：块数不少于1，不超过线程数的4倍，以便负载均衡
+        size_t count = end - begin;
+        size_t chunks = (count + grain - 1) / grain;
+        size_t max_chunks = (workers_.size() + 1) * 4;
+        if (chunks > max_chunks) {
+            chunks = max_chunks;
+        }
+        if (chunks <= 1) {
+            func(begin, end);
+            return;
+        }
+        size_t chunk_size = (count + chunks - 1) / chunks;
+        chunks = (count + chunk_size - 1) / chunk_size;
+
+        // 第一块由调用线程执行，其余块批量提交
+        // 各块引用本栈帧中的计数器、异常记录和 func，因此无论是否出现异常，都要等全部块结束才能返回
+        std::atomic<size_t> remaining(chunks - 1);
+        FirstError first_error;
+        TaskNode* head = nullptr;
+        TaskNode* tail = nullptr;
+        for (size_t c = 1; c < chunks; ++c) {
+            size_t chunk_begin = begin + c * chunk_size;
+            size_t chunk_end = std::min(chunk_begin + chunk_size, end);
+            TaskNode* node = acquireNode();
+            std::atomic<size_t>* counter = &remaining;
+            FirstError* error = &first_error;
+            typename std::remove_reference<F>::type* fn = &func;
+            node->task.assign([fn, chunk_begin, chunk_end, counter, error]() {
+                CountdownGuard guard(counter);
+                if (error->failed.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                try {
+                    (*fn)(chunk_begin, chunk_end);
+                } catch (...) {
+                    error->capture();
+                }
+            });
+            node->next = nullptr;
+            if (tail) {
+                tail->next = node;
+            } else {
+                head = node;
+            }
+            tail = node;
+        }
+        pushBatch(head, tail, chunks - 1);
+
+        try {
+            func(begin, std::min(begin + chunk_size, end));
+        } catch (...) {
+            first_error.capture();
+        }
+
+        // 等待其余块完成，期间帮助执行队列中的任务
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (!runPendingTask()) {
+                std::this_thread::yield();
+            }
+        }
+        if (first_error.error) {
+            std::rethrow_exception(first_error.error);
+        }
+    }
 
     /**
      * 等待所有任务完成
+     * 等待期间调用线程会帮助执行队列中的任务；不能在线程池的任务内部调用
      */
     void waitForCompletion();
 
+    /**
+     * 获取工作线程数量
+     * @return 线程数量
+     */
+    size_t size() const;
+
+    /**
+     * 获取等待执行的任务数量（不含正在执行的任务）
+     * @return 排队中的任务数
+     */
+    size_t pendingTasks() const;
+
 private:
+    friend struct NodeCache;
+
+    // 任务节点，通过 next 串成侵入式链表
+    struct TaskNode {
+        PoolTask task;
+        TaskNode* next;
+
+        TaskNode() : next(nullptr) {}
+    };
+
+    // 块计数器，任务结束（包括抛出异常）时减一
+    struct CountdownGuard {
+        std::atomic<size_t>* counter;
+        explicit CountdownGuard(std::atomic<size_t>* c) : counter(c) {}
+        ~CountdownGuard() { counter->fetch_sub(1, std::memory_order_release); }
+    };
+
+    // parallelFor 一次调用中的第一个异常；写入发生在块计数器减一之前，调用线程等到计数归零后读取
+    struct FirstError {
+        std::atomic<bool> failed;
+        std::exception_ptr error;
+
+        FirstError() : failed(false) {}
+
+        void capture() {
+            if (!failed.exchange(true)) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    class WorkStealingDeque;
+
+    // 从线程本地空闲链表获取任务节点
+    static TaskNode* acquireNode();
+
+    // 归还任务节点到线程本地空闲链表
+    static void releaseNode(TaskNode* node);
+
+    // 批量压入任务：工作线程压入自己的队列，外部线程压入注入队列
+    void pushBatch(TaskNode* head, TaskNode* tail, size_t count);
+
+    // 查找一个可执行的任务：自己的队列 -> 注入队列 -> 窃取
+    TaskNode* findTask(size_t self);
+
+    // 执行一个排队中的任务，没有任务时返回false
+    bool runPendingTask();
+
+    // 执行任务节点并回收
+    void runNode(TaskNode* node);
+
     // 工作线程函数
-    void workerThread();
+    void workerThread(size_t index);
 
     std::vector<std::thread> workers_; // 工作线程
-    std::queue<std::function<void()>> tasks_; // 任务队列
-    std::mutex queue_mutex_; // 队列互斥锁
-    std::condition_variable condition_; // 条件变量
+    std::vector<std::unique_ptr<WorkStealingDeque> > deques_; // 每个工作线程的任务队列
+    TaskNode* injected_head_; // 注入队列头
+    TaskNode* injected_tail_; // 注入队列尾
+    size_t injected_count_; // 注入队列长度
+    std::mutex queue_mutex_; // 注入队列互斥锁
+    std::mutex sleep_mutex_; // 休眠互斥锁
+    std::condition_variable condition_; // 唤醒空闲线程的条件变量
+    std::atomic<size_t> sleepers_; // 休眠中的线程数
+    std::atomic<size_t> pending_; // 排队中的任务数
     std::atomic<bool> stop_; // 是否停止
-    std::atomic<size_t> active_tasks_; // 活跃任务数
+    std::atomic<size_t> active_tasks_; // 已提交但未完成的任务数
     std::mutex active_tasks_mutex_; // 活跃任务数互斥锁
+    std::condition_variable completion_; // 所有任务完成的条件变量
 };
 
-#endif // THREAD_DEAL_H
\ No newline at end of file
+#endif // THREAD_DEAL_H
@@ -0,0 +1,60 @@
+#ifndef V4L2_CAPTURE_H
+#define V4L2_CAPTURE_H
+
+#include "capture_backend.h"
+#include <memory>
+#include <string>
+
+/**
+ * V4L2 mmap 流式采集后端
+ * 驱动缓冲区通过 mmap 映射到用户空间，出队后直接包装为 cv::Mat 头部，不做拷贝和解码；
+ * 帧的租约释放时缓冲区重新入队
+ */
+class V4l2Capture : public CaptureBackend {
+public:
+    /**
+     * 构造函数
+     * @param device 设备路径，如 /dev/video0
+     * @param width 期望宽度
+     * @param height 期望高度
+     * @param format 期望像素格式（YUYV、NV12 或 GRAY）
+     * @param buffer_count 驱动缓冲区数量
+     */
+    V4l2Capture(const std::string& device, int width, int height,
+                PixelFormat format = PixelFormat::YUYV, int buffer_count = 4);
+
+    /**
+     * 析构函数
+     */
+    ~V4l2Capture();
+
+    bool open() override;
+    bool grab(CaptureFrame& frame) override;
+    void close() override;
+    bool isOpened() const override;
+
+    /**
+     * 获取驱动协商后的图像宽度
+     * @return 宽度
+     */
+    int width() const;
+
+    /**
+     * 获取驱动协商后的图像高度
+     * @return 高度
+     */
+    int height() const;
+
+private:
+    struct Stream;
+
+    std::string device_; // 设备路径
+    int width_; // 图像宽度
+    int height_; // 图像高度
+    PixelFormat format_; // 像素格式
+    int buffer_count_; // 缓冲区数量
+    int timeout_ms_; // 等待一帧的超时时间
+    std::shared_ptr<Stream> stream_; // 流状态，由所有未归还的租约共享
+};
+
+#endif // V4L2_CAPTURE_H
@@ -0,0 +1,25 @@
+#ifndef YUV_LUMA_H
+#define YUV_LUMA_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * 从打包的 YUYV (YUV 4:2:2) 图像中提取亮度平面
+ * 运行时根据 CPU 支持的指令集选择 AVX2 / SSE2 / NEON / 标量实现
+ * @param src YUYV 数据起始地址
+ * @param src_stride YUYV 每行字节数
+ * @param dst 亮度输出起始地址
+ * @param dst_stride 亮度每行字节数
+ * @param width 图像宽度（像素）
+ * @param height 图像高度（像素）
+ */
+void extractLumaYuyv(const uint8_t* src, size_t src_stride, uint8_t* dst, size_t dst_stride, int width, int height);
+
+/**
+ * 获取当前选用的亮度提取实现名称
+ * @return 实现名称，如 "avx2"
+ */
+const char* lumaKernelName();
+
+#endif // YUV_LUMA_H
@@ -0,0 +1,160 @@
+#include "capture_backend.h"
+#include <iostream>
+#include <algorithm>
+#include <thread>
+#include <sys/stat.h>
+
+int64_t captureNowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+OpenCvCapture::OpenCvCapture(int camera_id) : camera_id_(camera_id), sequence_(0) {
+    // 构造函数初始化
+}
+
+bool OpenCvCapture::open() {
+    camera_.open(camera_id_);
+    if (!camera_.isOpened()) {
+        std::cerr << "无法打开摄像头: " << camera_id_ << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool OpenCvCapture::grab(CaptureFrame& frame) {
+    // 每帧使用新的缓冲区，避免覆盖仍在其他线程中使用的帧
+    frame.image.release();
+    frame.lease.reset();
+    if (!camera_.read(frame.image)) {
+        return false;
+    }
+    frame.format = PixelFormat::BGR;
+    frame.sequence = sequence_++;
+    frame.timestamp_us = captureNowMicros();
+    frame.read_only = false;
+    return true;
+}
+
+void OpenCvCapture::close() {
+    camera_.release();
+}
+
+bool OpenCvCapture::isOpened() const {
+    return camera_.isOpened();
+}
+
+ReplayCapture::ReplayCapture(const std::string& path, bool loop, double fps, PixelFormat format)
+    : path_(path),
+      loop_(loop),
+      fps_(fps),
+      format_(format == PixelFormat::GRAY ? PixelFormat::GRAY : PixelFormat::BGR),
+      is_open_(false),
+      next_index_(0),
+      sequence_(0) {
+    // 构造函数初始化
+}
+
+bool ReplayCapture::open() {
+    close();
+
+    struct stat st;
+    if (stat(path_.c_str(), &st) != 0) {
+        std::cerr << "回放路径不存在: " << path_ << std::endl;
+        return false;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        // 图片目录：按文件名排序后全部载入内存
+        std::vector<cv::String> files;
+        cv::glob(path_ + "/*", files, false);
+        std::sort(files.begin(), files.end());
+        for (size_t i = 0; i < files.size(); ++i) {
+            std::string name = files[i];
+            std::string ext = name.substr(name.find_last_of('.') + 1);
+            std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+            if (ext != "png" && ext != "jpg" && ext != "jpeg" && ext != "bmp") {
+                continue;
+            }
+            cv::Mat image = cv::imread(name, format_ == PixelFormat::GRAY ? cv::IMREAD_GRAYSCALE : cv::IMREAD_COLOR);
+            if (!image.empty()) {
+                frames_.push_back(image);
+            }
+        }
+        if (frames_.empty()) {
+            std::cerr << "回放目录中没有可用的图片: " << path_ << std::endl;
+            return false;
+        }
+    } else {
+        // 视频文件：逐帧解码
+        video_.open(path_);
+        if (!video_.isOpened()) {
+            std::cerr << "无法打开回放视频: " << path_ << std::endl;
+            return false;
+        }
+    }
+
+    next_index_ = 0;
+    next_time_ = std::chrono::steady_clock::now();
+    is_open_ = true;
+    return true;
+}
+
+bool ReplayCapture::grab(CaptureFrame& frame) {
+    if (!is_open_) {
+        return false;
+    }
+
+    // 按设定帧率限速，模拟摄像头
+    if (fps_ > 0) {
+        std::this_thread::sleep_until(next_time_);
+        next_time_ += std::chrono::microseconds(static_cast<int64_t>(1e6 / fps_));
+    }
+
+    frame.lease.reset();
+    if (!frames_.empty()) {
+        if (next_index_ >= frames_.size()) {
+            if (!loop_) {
+                return false;
+            }
+            next_index_ = 0;
+        }
+        // 直接共享内存中的图片，不拷贝
+        frame.image = frames_[next_index_++];
+        frame.read_only = true;
+    } else {
+        frame.image.release();
+        if (!video_.read(frame.image)) {
+            if (!loop_) {
+                return false;
+            }
+            video_.set(cv::CAP_PROP_POS_FRAMES, 0);
+            if (!video_.read(frame.image)) {
+                return false;
+            }
+        }
+        if (format_ == PixelFormat::GRAY) {
+            cv::cvtColor(frame.image, frame.image, cv::COLOR_BGR2GRAY);
+        }
+        frame.read_only = false;
+    }
+
+    frame.format = frame.image.channels() == 1 ? PixelFormat::GRAY : PixelFormat::BGR;
+    frame.sequence = sequence_++;
+    frame.timestamp_us = captureNowMicros();
+    return true;
+}
+
+void ReplayCapture::close() {
+    frames_.clear();
+    video_.release();
+    is_open_ = false;
+}
+
+bool ReplayCapture::isOpened() const {
+    return is_open_;
+}
+
+size_t ReplayCapture::frameCount() const {
+    return frames_.size();
+}
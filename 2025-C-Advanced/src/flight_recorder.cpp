@@ -0,0 +1,225 @@
+#include "flight_recorder.h"
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sys/stat.h>
+
+namespace {
+
+// 创建目录，已存在时视为成功
+bool makeDirectory(const std::string& path) {
+    if (mkdir(path.c_str(), 0755) == 0 || errno == EEXIST) {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    }
+    return false;
+}
+
+// 触发原因只保留字母、数字和下划线，用于目录名
+std::string sanitizeReason(const std::string& reason) {
+    std::string result;
+    for (size_t i = 0; i < reason.size(); ++i) {
+        char c = reason[i];
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+        result += ok ? c : '_';
+    }
+    return result.empty() ? "manual" : result;
+}
+
+} // namespace
+
+std::atomic<bool> FlightRecorder::signal_requested_(false);
+
+FlightRecorder::FlightRecorder(const std::string& output_dir, size_t capacity, size_t post_trigger_frames)
+    : output_dir_(output_dir),
+      capacity_(capacity > 0 ? capacity : 1),
+      post_trigger_frames_(post_trigger_frames < capacity_ ? post_trigger_frames : capacity_ - 1),
+      ring_(capacity_),
+      head_(0),
+      count_(0),
+      dump_busy_(false),
+      triggered_(false),
+      post_remaining_(0),
+      stop_(false),
+      dumps_written_(0),
+      triggers_skipped_(0) {
+    // 构造函数初始化，两块环形缓冲区一次性分配
+    dump_.entries.resize(capacity_);
+}
+
+FlightRecorder::~FlightRecorder() {
+    // 析构函数等待写盘完成
+    stop();
+}
+
+bool FlightRecorder::start() {
+    if (writer_thread_.joinable()) {
+        return true;
+    }
+    if (!makeDirectory(output_dir_)) {
+        std::cerr << "无法创建飞行记录目录: " << output_dir_ << std::endl;
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+    }
+    writer_thread_ = std::thread(&FlightRecorder::writerThread, this);
+    return true;
+}
+
+void FlightRecorder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        // 已触发但后续帧不再到来时，把已有的帧写盘
+        if (triggered_ && !dump_busy_ && count_ > 0) {
+            dump_.entries.swap(ring_);
+            dump_.first = (head_ + capacity_ - count_) % capacity_;
+            dump_.count = count_;
+            dump_.reason = trigger_reason_;
+            dump_busy_ = true;
+            triggered_ = false;
+            head_ = 0;
+            count_ = 0;
+        }
+        stop_ = true;
+        dump_ready_.notify_all();
+    }
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+}
+
+void FlightRecorder::record(const FramePacket& packet) {
+    if (signal_requested_.exchange(false, std::memory_order_relaxed)) {
+        trigger("signal");
+    }
+
+    // 只保存引用：流水线每帧使用新的缓冲区，共享不会被覆盖
+    Entry& entry = ring_[head_];
+    entry.sequence = packet.sequence;
+    entry.capture_us = packet.capture_us;
+    entry.frame = packet.frame;
+    entry.result_image = packet.result_image;
+    entry.min_square = packet.min_square;
+    head_ = (head_ + 1) % capacity_;
+    if (count_ < capacity_) {
+        ++count_;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!triggered_) {
+        return;
+    }
+    if (post_remaining_ > 0) {
+        --post_remaining_;
+        return;
+    }
+
+    // 后续帧已记录完毕：与空闲的备用缓冲区交换，交给后台线程写盘
+    dump_.entries.swap(ring_);
+    dump_.first = (head_ + capacity_ - count_) % capacity_;
+    dump_.count = count_;
+    dump_.reason = trigger_reason_;
+    dump_busy_ = true;
+    triggered_ = false;
+    head_ = 0;
+    count_ = 0;
+    dump_ready_.notify_one();
+}
+
+void FlightRecorder::trigger(const std::string& reason) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (triggered_ || dump_busy_) {
+        triggers_skipped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    triggered_ = true;
+    post_remaining_ = post_trigger_frames_;
+    trigger_reason_ = reason;
+}
+
+void FlightRecorder::requestTrigger() {
+    signal_requested_.store(true, std::memory_order_relaxed);
+}
+
+uint64_t FlightRecorder::dumpsWritten() const {
+    return dumps_written_.load(std::memory_order_relaxed);
+}
+
+uint64_t FlightRecorder::triggersSkipped() const {
+    return triggers_skipped_.load(std::memory_order_relaxed);
+}
+
+void FlightRecorder::writerThread() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        dump_ready_.wait(lock, [this]() { return dump_busy_ || stop_; });
+        if (!dump_busy_) {
+            break;
+        }
+
+        // dump_ 在 dump_busy_ 为 true 期间只由本线程访问
+        lock.unlock();
+        if (writeDump(dump_)) {
+            dumps_written_.fetch_add(1, std::memory_order_relaxed);
+        }
+        // 释放图像引用，缓冲区作为下一次的备用缓冲区
+        for (size_t i = 0; i < dump_.entries.size(); ++i) {
+            dump_.entries[i].frame.release();
+            dump_.entries[i].result_image.release();
+            dump_.entries[i].min_square.clear();
+        }
+        lock.lock();
+        dump_busy_ = false;
+    }
+}
+
+bool FlightRecorder::writeDump(const Dump& dump) {
+    // 每次保存一个子目录：flight_<日期>_<时间>_<原因>
+    char stamp[32];
+    time_t now = time(nullptr);
+    struct tm local;
+    localtime_r(&now, &local);
+    strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &local);
+    std::string dir = output_dir_ + "/flight_" + stamp + "_" + sanitizeReason(dump.reason);
+    if (!makeDirectory(dir)) {
+        std::cerr << "无法创建飞行记录目录: " << dir << std::endl;
+        return false;
+    }
+
+    std::ofstream csv((dir + "/detections.csv").c_str());
+    csv << "sequence,capture_us,found,x0,y0,x1,y1,x2,y2,x3,y3\n";
+
+    std::vector<int> params;
+    params.push_back(cv::IMWRITE_JPEG_QUALITY);
+    params.push_back(95);
+    for (size_t n = 0; n < dump.count; ++n) {
+        const Entry& entry = dump.entries[(dump.first + n) % dump.entries.size()];
+        char name[64];
+        if (!entry.frame.empty()) {
+            snprintf(name, sizeof(name), "/frame_%06llu.jpg", static_cast<unsigned long long>(entry.sequence));
+            cv::imwrite(dir + name, entry.frame, params);
+        }
+        if (!entry.result_image.empty()) {
+            snprintf(name, sizeof(name), "/result_%06llu.jpg", static_cast<unsigned long long>(entry.sequence));
+            cv::imwrite(dir + name, entry.result_image, params);
+        }
+
+        csv << entry.sequence << "," << entry.capture_us << "," << (entry.min_square.size() == 4 ? 1 : 0);
+        for (size_t i = 0; i < 4; ++i) {
+            if (i < entry.min_square.size()) {
+                csv << "," << entry.min_square[i].x << "," << entry.min_square[i].y;
+            } else {
+                csv << ",,";
+            }
+        }
+        csv << "\n";
+    }
+
+    std::cout << "飞行记录已保存: " << dir << "（" << dump.count << " 帧）" << std::endl;
+    return true;
+}
@@ -0,0 +1,169 @@
+#include "frame_pipeline.h"
+#include "capture_backend.h"
+#include <iostream>
+
+FramePipeline::FramePipeline(CaptureFunc capture, DetectFunc detect, size_t num_workers, size_t queue_capacity)
+    : capture_(capture),
+      detect_(detect),
+      num_workers_(num_workers > 0 ? num_workers : 1),
+      reorder_capacity_(queue_capacity > 0 ? queue_capacity : 1),
+      input_queue_(queue_capacity),
+      next_sequence_(0),
+      active_workers_(0),
+      capture_hist_(nullptr),
+      queue_wait_hist_(nullptr),
+      detect_hist_(nullptr),
+      queue_depth_hist_(nullptr),
+      stop_(false),
+      started_(false) {
+    // 构造函数初始化
+}
+
+FramePipeline::~FramePipeline() {
+    // 析构函数停止流水线
+    stop();
+}
+
+void FramePipeline::setStats(LatencyStats* stats) {
+    if (started_ || !stats) {
+        return;
+    }
+    capture_hist_ = &stats->histogram("capture_us");
+    queue_wait_hist_ = &stats->histogram("queue_wait_us");
+    detect_hist_ = &stats->histogram("detect_us");
+    queue_depth_hist_ = &stats->histogram("input_queue_depth");
+}
+
+void FramePipeline::setRecognizer(RecognizeFunc recognize) {
+    if (started_) {
+        return;
+    }
+    recognize_ = recognize;
+}
+
+void FramePipeline::start() {
+    if (started_) {
+        return;
+    }
+    started_ = true;
+
+    {
+        std::lock_guard<std::mutex> lock(reorder_mutex_);
+        active_workers_ = num_workers_;
+    }
+
+    for (size_t i = 0; i < num_workers_; ++i) {
+        workers_.push_back(std::thread(&FramePipeline::workerThread, this));
+    }
+    capture_thread_ = std::thread(&FramePipeline::captureThread, this);
+}
+
+void FramePipeline::stop() {
+    stop_ = true;
+    input_queue_.close();
+    {
+        std::lock_guard<std::mutex> lock(reorder_mutex_);
+        reorder_space_.notify_all();
+        result_ready_.notify_all();
+    }
+
+    if (capture_thread_.joinable()) {
+        capture_thread_.join();
+    }
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        if (workers_[i].joinable()) {
+            workers_[i].join();
+        }
+    }
+    workers_.clear();
+}
+
+bool FramePipeline::nextResult(FramePacket& packet) {
+    std::unique_lock<std::mutex> lock(reorder_mutex_);
+    result_ready_.wait(lock, [this]() {
+        return reorder_buffer_.count(next_sequence_) > 0 || active_workers_ == 0;
+    });
+
+    std::map<uint64_t, FramePacket>::iterator it = reorder_buffer_.find(next_sequence_);
+    if (it == reorder_buffer_.end()) {
+        // 所有识别线程都已退出，且下一帧不会再到达
+        return false;
+    }
+
+    packet = std::move(it->second);
+    reorder_buffer_.erase(it);
+    ++next_sequence_;
+    reorder_space_.notify_all();
+    return true;
+}
+
+void FramePipeline::captureThread() {
+    uint64_t sequence = 0;
+    while (!stop_) {
+        FramePacket packet;
+        packet.sequence = sequence;
+
+        // 采集新的一帧
+        int64_t start_us = captureNowMicros();
+        if (!capture_(packet.frame) || packet.frame.empty()) {
+            std::cerr << "无法获取图像帧" << std::endl;
+            break;
+        }
+        packet.capture_us = captureNowMicros();
+        if (capture_hist_) {
+            capture_hist_->record(packet.capture_us - start_us);
+            queue_depth_hist_->record(input_queue_.size());
+        }
+
+        // 队列满时阻塞，形成背压
+        if (!input_queue_.push(std::move(packet))) {
+            break;
+        }
+        ++sequence;
+    }
+
+    // 通知识别线程不会再有新帧
+    input_queue_.close();
+}
+
+void FramePipeline::workerThread() {
+    FramePacket packet;
+    while (input_queue_.pop(packet)) {
+        int64_t start_us = captureNowMicros();
+
+        // 创建结果图像并识别，灰度帧转为彩色以便标注
+        if (packet.frame.channels() == 1) {
+            cv::cvtColor(packet.frame, packet.result_image, cv::COLOR_GRAY2BGR);
+        } else {
+            packet.result_image = packet.frame.clone();
+        }
+        packet.min_square.clear();
+        packet.digits.clear();
+        if (recognize_) {
+            recognize_(packet.frame, packet.result_image, packet.min_square, packet.digits);
+        } else {
+            detect_(packet.frame, packet.result_image, packet.min_square);
+        }
+        packet.detect_end_us = captureNowMicros();
+        if (detect_hist_) {
+            queue_wait_hist_->record(start_us - packet.capture_us);
+            detect_hist_->record(packet.detect_end_us - start_us);
+        }
+
+        // 放入乱序缓冲区，缓冲区满时只允许下一个待交付的帧进入，避免死锁
+        std::unique_lock<std::mutex> lock(reorder_mutex_);
+        uint64_t sequence = packet.sequence;
+        reorder_space_.wait(lock, [this, sequence]() {
+            return stop_ || reorder_buffer_.size() < reorder_capacity_ || sequence == next_sequence_;
+        });
+        if (stop_) {
+            break;
+        }
+        reorder_buffer_[sequence] = std::move(packet);
+        result_ready_.notify_all();
+    }
+
+    std::lock_guard<std::mutex> lock(reorder_mutex_);
+    --active_workers_;
+    result_ready_.notify_all();
+}
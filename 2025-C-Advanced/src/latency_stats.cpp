@@ -0,0 +1,269 @@
+#include "latency_stats.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+// 线性分桶的位数：小于 2^5 的值每个值一个桶，更大的值保留最高5位
+const int kSubBucketBits = 5;
+const uint64_t kLinearLimit = 1ULL << kSubBucketBits;
+const uint64_t kHalfSubBuckets = kLinearLimit / 2;
+
+// 为当前线程分配的分片下标
+size_t threadShard() {
+    static std::atomic<size_t> next_shard(0);
+    static thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) %
+                                       LatencyHistogram::kShardCount;
+    return shard;
+}
+
+// 原子地更新最小值/最大值
+void atomicMin(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void atomicMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+const size_t LatencyHistogram::kBucketCount;
+const size_t LatencyHistogram::kShardCount;
+
+std::atomic<bool> LatencyStats::dump_requested_(false);
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    // 第 ceil(q * count) 个样本所在的桶
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * count));
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint64_t low = LatencyHistogram::bucketLowerBound(i);
+            uint64_t high = LatencyHistogram::bucketUpperBound(i);
+            uint64_t value = low + (high - low) / 2;
+            // 桶中点可能超出实际观测范围，截断到 [min, max]
+            if (value < min) {
+                value = min;
+            }
+            if (value > max) {
+                value = max;
+            }
+            return value;
+        }
+    }
+    return max;
+}
+
+LatencyHistogram::LatencyHistogram(const std::string& name) : name_(name), shards_(new Shard[kShardCount]) {
+    // 构造函数初始化
+    reset();
+}
+
+void LatencyHistogram::record(uint64_t value) {
+    Shard& shard = shards_[threadShard()];
+    shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    atomicMin(shard.min, value);
+    atomicMax(shard.max, value);
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    HistogramSnapshot snapshot;
+    snapshot.name = name_;
+    snapshot.buckets.assign(kBucketCount, 0);
+
+    uint64_t sum = 0;
+    uint64_t min = UINT64_MAX;
+    uint64_t max = 0;
+    for (size_t s = 0; s < kShardCount; ++s) {
+        const Shard& shard = shards_[s];
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            uint64_t n = shard.buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += n;
+            snapshot.count += n;
+        }
+        sum += shard.sum.load(std::memory_order_relaxed);
+        min = std::min(min, shard.min.load(std::memory_order_relaxed));
+        max = std::max(max, shard.max.load(std::memory_order_relaxed));
+    }
+
+    if (snapshot.count > 0) {
+        snapshot.min = min;
+        snapshot.max = max;
+        snapshot.mean = static_cast<double>(sum) / snapshot.count;
+    }
+    return snapshot;
+}
+
+void LatencyHistogram::reset() {
+    for (size_t s = 0; s < kShardCount; ++s) {
+        Shard& shard = shards_[s];
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            shard.buckets[i].store(0, std::memory_order_relaxed);
+        }
+        shard.count.store(0, std::memory_order_relaxed);
+        shard.sum.store(0, std::memory_order_relaxed);
+        shard.min.store(UINT64_MAX, std::memory_order_relaxed);
+        shard.max.store(0, std::memory_order_relaxed);
+    }
+}
+
+const std::string& LatencyHistogram::name() const {
+    return name_;
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < kLinearLimit) {
+        return static_cast<size_t>(value);
+    }
+    // 最高位所在的2的幂区间，区间内按接下来的4位均分
+    int msb = 63 - __builtin_clzll(value);
+    int shift = msb - (kSubBucketBits - 1);
+    uint64_t top = value >> shift;
+    return static_cast<size_t>(kLinearLimit + (msb - kSubBucketBits) * kHalfSubBuckets + (top - kHalfSubBuckets));
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t index) {
+    if (index < kLinearLimit) {
+        return index;
+    }
+    size_t k = index - kLinearLimit;
+    int msb = static_cast<int>(k / kHalfSubBuckets) + kSubBucketBits;
+    uint64_t top = k % kHalfSubBuckets + kHalfSubBuckets;
+    return top << (msb - (kSubBucketBits - 1));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < kLinearLimit) {
+        return index;
+    }
+    size_t k = index - kLinearLimit;
+    int msb = static_cast<int>(k / kHalfSubBuckets) + kSubBucketBits;
+    uint64_t width = 1ULL << (msb - (kSubBucketBits - 1));
+    return bucketLowerBound(index) + (width - 1);
+}
+
+LatencyStats::LatencyStats() : dump_stop_(false) {
+    // 构造函数初始化
+}
+
+LatencyStats::~LatencyStats() {
+    // 析构函数停止后台线程
+    stopPeriodicDump();
+}
+
+LatencyHistogram& LatencyStats::histogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        if (histograms_[i]->name() == name) {
+            return *histograms_[i];
+        }
+    }
+    histograms_.push_back(std::unique_ptr<LatencyHistogram>(new LatencyHistogram(name)));
+    return *histograms_.back();
+}
+
+std::atomic<uint64_t>& LatencyStats::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < counter_names_.size(); ++i) {
+        if (counter_names_[i] == name) {
+            return *counters_[i];
+        }
+    }
+    counter_names_.push_back(name);
+    counters_.push_back(std::unique_ptr<std::atomic<uint64_t>>(new std::atomic<uint64_t>(0)));
+    return *counters_.back();
+}
+
+std::vector<HistogramSnapshot> LatencyStats::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<HistogramSnapshot> snapshots;
+    for (size_t i = 0; i < histograms_.size(); ++i) {
+        snapshots.push_back(histograms_[i]->snapshot());
+    }
+    return snapshots;
+}
+
+void LatencyStats::report(std::ostream& out) const {
+    std::vector<HistogramSnapshot> snapshots = snapshot();
+
+    out << "---- 延迟统计 ----" << std::endl;
+    out << std::left << std::setw(22) << "name" << std::right << std::setw(10) << "count" << std::setw(10) << "p50"
+        << std::setw(10) << "p99" << std::setw(10) << "p999" << std::setw(10) << "max" << std::endl;
+    for (size_t i = 0; i < snapshots.size(); ++i) {
+        const HistogramSnapshot& s = snapshots[i];
+        out << std::left << std::setw(22) << s.name << std::right << std::setw(10) << s.count << std::setw(10)
+            << s.percentile(0.5) << std::setw(10) << s.percentile(0.99) << std::setw(10) << s.percentile(0.999)
+            << std::setw(10) << s.max << std::endl;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < counter_names_.size(); ++i) {
+        out << std::left << std::setw(22) << counter_names_[i] << std::right << std::setw(10)
+            << counters_[i]->load(std::memory_order_relaxed) << std::endl;
+    }
+}
+
+void LatencyStats::startPeriodicDump(double interval_s) {
+    stopPeriodicDump();
+    {
+        std::lock_guard<std::mutex> lock(dump_mutex_);
+        dump_stop_ = false;
+    }
+    dump_thread_ = std::thread(&LatencyStats::dumpThread, this, interval_s);
+}
+
+void LatencyStats::stopPeriodicDump() {
+    {
+        std::lock_guard<std::mutex> lock(dump_mutex_);
+        dump_stop_ = true;
+    }
+    dump_cv_.notify_all();
+    if (dump_thread_.joinable()) {
+        dump_thread_.join();
+    }
+}
+
+void LatencyStats::requestDump() {
+    dump_requested_.store(true, std::memory_order_relaxed);
+}
+
+void LatencyStats::dumpThread(double interval_s) {
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point next_dump = Clock::now() + std::chrono::microseconds(static_cast<int64_t>(interval_s * 1e6));
+
+    std::unique_lock<std::mutex> lock(dump_mutex_);
+    while (!dump_stop_) {
+        // 信号处理函数不能通知条件变量，因此定期检查输出请求
+        dump_cv_.wait_for(lock, std::chrono::milliseconds(200));
+        if (dump_stop_) {
+            break;
+        }
+
+        bool due = interval_s > 0 && Clock::now() >= next_dump;
+        if (dump_requested_.exchange(false, std::memory_order_relaxed) || due) {
+            lock.unlock();
+            report(std::cout);
+            lock.lock();
+            if (due) {
+                next_dump = Clock::now() + std::chrono::microseconds(static_cast<int64_t>(interval_s * 1e6));
+            }
+        }
+    }
+}
@@ -1,72 +1,313 @@
 #include <iostream>
 #include <string>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <csignal>
+#include <memory>
+#include <chrono>
+#include <algorithm>
 #include "pic_deal.h"
+#include "v4l2_capture.h"
+#include "frame_pipeline.h"
+#include "shibie_Square_min.h"
+#include "square_tracker.h"
+#include "square_classifier.h"
 #include "thread_deal.h"
+#include "latency_stats.h"
+#include "frame_mailbox.h"
+#include "preview_server.h"
+#include "flight_recorder.h"
 #include <opencv2/opencv.hpp>
 
-// 声明识别正方形的函数
-void shibie_Square_min(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square);
+namespace {
+
+// 收到 SIGINT/SIGTERM 后置位，主循环据此退出
+volatile sig_atomic_t g_quit = 0;
+
+void onQuitSignal(int) {
+    g_quit = 1;
+}
+
+} // namespace
 
 int main(int argc, char** argv) {
     std::cout << "程序启动: 正方形识别与最小正方形检测" << std::endl;
 
-    // 初始化图像处理类
+    // 解析命令行参数
+    // 用法: square_detection [--v4l2 <设备>] [--size <宽>x<高>] [--replay <图片目录或视频>] [--fps <帧率>] [--luma]
+    //                         [--track <全图检测间隔>] [--pyramid <层数>] [--subpix]
+    //                         [--tiles <分块边长>] [--tile-overlap <重叠宽度>] [--stats <统计输出间隔秒数>]
+    //                         [--headless] [--preview <端口>] [--record <帧数>] [--record-dir <目录>]
+    //                         [--digits <SquareNet 权重文件>]
+    std::string v4l2_device;
+    std::string replay_path;
+    int width = 1280;
+    int height = 720;
+    double replay_fps = 0;
+    bool luma = false;
+    int track_interval = 0;
+    SquareDetectOptions detect_options;
+    int tile_size = 0;
+    double stats_interval = 10;
+    bool headless = false;
+    int preview_port = 0;
+    int record_frames = 0;
+    std::string record_dir = "flight_records";
+    std::string digits_weights;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--v4l2" && i + 1 < argc) {
+            v4l2_device = argv[++i];
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (arg == "--size" && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                std::cerr << "无效的分辨率: " << argv[i] << std::endl;
+                return -1;
+            }
+        } else if (arg == "--fps" && i + 1 < argc) {
+            replay_fps = atof(argv[++i]);
+        } else if (arg == "--luma") {
+            luma = true;
+        } else if (arg == "--track" && i + 1 < argc) {
+            track_interval = atoi(argv[++i]);
+        } else if (arg == "--pyramid" && i + 1 < argc) {
+            // 金字塔检测时顶点精度下降，总是配合亚像素精化使用
+            detect_options.pyramid_levels = atoi(argv[++i]);
+            detect_options.refine_corners = true;
+        } else if (arg == "--tiles" && i + 1 < argc) {
+            tile_size = atoi(argv[++i]);
+        } else if (arg == "--tile-overlap" && i + 1 < argc) {
+            detect_options.tile_overlap = std::max(0, atoi(argv[++i]));
+        } else if (arg == "--stats" && i + 1 < argc) {
+            stats_interval = atof(argv[++i]);
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--preview" && i + 1 < argc) {
+            preview_port = atoi(argv[++i]);
+        } else if (arg == "--record" && i + 1 < argc) {
+            record_frames = atoi(argv[++i]);
+        } else if (arg == "--record-dir" && i + 1 < argc) {
+            record_dir = argv[++i];
+        } else if (arg == "--digits" && i + 1 < argc) {
+            digits_weights = argv[++i];
+        } else if (arg == "--subpix") {
+            detect_options.refine_corners = true;
+        } else {
+            std::cerr << "未知参数: " << arg << std::endl;
+            return -1;
+        }
+    }
+
+    // 初始化图像处理类，--luma 时直接采集亮度平面，跳过 BGR 转换
     PicDeal pic_deal;
+    if (luma) {
+        pic_deal.setCaptureMode(CaptureMode::LUMA);
+    }
 
-    // 从摄像头读取图像
-    if (!pic_deal.readFromCamera(0)) {
-        std::cerr << "无法打开摄像头 /dev/video0" << std::endl;
+    // 打开图像来源：V4L2 mmap、录像回放或默认摄像头
+    bool opened = false;
+    if (!replay_path.empty()) {
+        PixelFormat replay_format = luma ? PixelFormat::GRAY : PixelFormat::BGR;
+        opened = pic_deal.openCapture(std::unique_ptr<CaptureBackend>(
+            new ReplayCapture(replay_path, true, replay_fps, replay_format)));
+    } else if (!v4l2_device.empty()) {
+        opened = pic_deal.openCapture(std::unique_ptr<CaptureBackend>(new V4l2Capture(v4l2_device, width, height)));
+    } else {
+        opened = pic_deal.readFromCamera(0);
+    }
+    if (!opened) {
+        std::cerr << "无法打开图像来源" << std::endl;
         return -1;
     }
-    std::cout << "摄像头已打开，开始处理图像..." << std::endl;
-
-    // 创建线程池
-    ThreadPool thread_pool(4);
-
-    // 主循环
-    bool running = true;
-    while (running) {
-        // 获取当前图像
-        cv::Mat frame = pic_deal.getCurrentImage();
-        if (frame.empty()) {
-            std::cerr << "无法获取图像帧" << std::endl;
-            break;
-        }
+    std::cout << "图像来源已打开，开始处理图像..." << std::endl;
+
+    // 创建采集 -> 识别 -> 输出流水线
+    // 识别线程数与CPU核心数一致，采集与显示各占一个独立阶段
+    size_t num_workers = std::thread::hardware_concurrency();
+    if (num_workers == 0) {
+        num_workers = 4;
+    }
+
+    // 分块模式在一帧内部并行，降低单帧延迟；此时只用一个识别线程，其余核心交给线程池
+    std::unique_ptr<ThreadPool> tile_pool;
+    if (tile_size > 0) {
+        tile_pool.reset(new ThreadPool(num_workers > 1 ? num_workers - 1 : 1));
+        detect_options.pool = tile_pool.get();
+        detect_options.tile_size = tile_size;
+        num_workers = 1;
+    }
 
-        // 创建结果图像
-        cv::Mat result_image = frame.clone();
+    FramePipeline::DetectFunc detect =
+        [detect_options](const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square) {
+            shibie_Square_min(image, result_image, min_square, detect_options);
+        };
 
-        // 存储最小正方形的顶点
-        std::vector<cv::Point2f> min_square;
+    // 跟踪模式只在目标附近的 ROI 内检测，依赖帧顺序，因此只用一个识别线程
+    SquareTracker tracker(track_interval > 0 ? track_interval : 1);
+    if (track_interval > 0) {
+        num_workers = 1;
+        detect = [&tracker](const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square) {
+            tracker.process(image, result_image, min_square);
+        };
+    }
+
+    // 数字识别模式：每个正方形透视矫正为 128x128 后整批分类，分类器内部已用满全部核心，
+    // 且各帧共用一组缓冲区，因此只用一个识别线程
+    std::unique_ptr<SquareClassifier> classifier;
+    if (!digits_weights.empty()) {
+        if (track_interval > 0) {
+            std::cerr << "--digits 不能与 --track 同时使用" << std::endl;
+            return -1;
+        }
+        classifier.reset(new SquareClassifier(detect_options));
+        if (!classifier->loadWeights(digits_weights)) {
+            return -1;
+        }
+        num_workers = 1;
+    }
 
-        // 使用线程池处理图像
-        thread_pool.enqueue([&frame, &result_image, &min_square]() {
-            // 调用正方形识别函数
-            shibie_Square_min(frame, result_image, min_square);
+    // 统计中心需比流水线活得更久，流水线线程会向其中记录
+    LatencyStats stats;
+    FramePipeline pipeline(
+        [&pic_deal](cv::Mat& frame) { return pic_deal.readFrame(frame); },
+        detect,
+        num_workers,
+        num_workers + 1);
+    if (classifier) {
+        pipeline.setRecognizer([&classifier](const cv::Mat& image, cv::Mat& result_image,
+                                             std::vector<cv::Point2f>& min_square, std::vector<SquareDigit>& digits) {
+            classifier->process(image, result_image, min_square, digits);
         });
+    }
+
+    // 延迟统计：定期输出各阶段的 p50/p99/p999，收到 SIGUSR1 时立即输出
+    pipeline.setStats(&stats);
+    LatencyHistogram& end_to_end_hist = stats.histogram("end_to_end_us");
+    LatencyHistogram& reorder_wait_hist = stats.histogram("reorder_wait_us");
+    LatencyHistogram& display_hist = stats.histogram("display_us");
+    LatencyHistogram& pool_depth_hist = stats.histogram("pool_queue_depth");
+    std::atomic<uint64_t>& dropped_counter = stats.counter("dropped_frames");
+    std::atomic<uint64_t>& found_counter = stats.counter("frames_with_square");
+    std::atomic<uint64_t>& digit_counter = stats.counter("recognized_digits");
+    std::atomic<uint64_t>& gui_dropped_counter = stats.counter("gui_dropped_frames");
+    std::atomic<uint64_t>& preview_dropped_counter = stats.counter("preview_dropped_frames");
+    signal(SIGUSR1, [](int) { LatencyStats::requestDump(); });
+    signal(SIGINT, onQuitSignal);
+    signal(SIGTERM, onQuitSignal);
+    stats.startPeriodicDump(stats_interval);
+
+    // 预览输出都是可丢帧的旁路：MJPEG 服务和窗口显示各自从信箱取最新一帧，不反压识别
+    PreviewServer preview(preview_port);
+    if (preview_port > 0 && !preview.start()) {
+        return -1;
+    }
+    FrameMailbox<FramePacket> gui_mailbox;
+
+    // 飞行记录仪：保存最近 record_frames 帧，SIGUSR2 或识别异常时写盘，触发后再记录1/4容量的后续帧
+    std::unique_ptr<FlightRecorder> recorder;
+    if (record_frames > 0) {
+        recorder.reset(new FlightRecorder(record_dir, record_frames, record_frames / 4));
+        if (!recorder->start()) {
+            return -1;
+        }
+        signal(SIGUSR2, [](int) { FlightRecorder::requestTrigger(); });
+    }
 
-        // 等待任务完成
-        thread_pool.waitForCompletion();
+    pipeline.start();
 
-        // 显示结果
-        cv::imshow("原始图像", frame);
-        cv::imshow("识别结果", result_image);
+    // 输出线程：按帧序号顺序取出结果，记录统计并分发给各预览端，从不等待显示
+    std::atomic<bool> sink_done(false);
+    std::thread sink_thread([&]() {
+        FramePacket packet;
+        int found_streak = 0;
+        while (pipeline.nextResult(packet)) {
+            int64_t output_us = captureNowMicros();
+            end_to_end_hist.record(output_us - packet.capture_us);
+            reorder_wait_hist.record(output_us - packet.detect_end_us);
+            dropped_counter.store(pic_deal.droppedFrames(), std::memory_order_relaxed);
+            if (tile_pool) {
+                pool_depth_hist.record(tile_pool->pendingTasks());
+            }
 
-        // 显示最小正方形信息
-        if (!min_square.empty()) {
-            std::cout << "找到最小正方形，边长: ";
-            // 计算边长
-            float edge_length = cv::norm(min_square[0] - min_square[1]);
-            std::cout << edge_length << " 像素" << std::endl;
+            // 在结果图像上标注最小正方形边长（四条边的平均值），不再逐帧打印到终端
+            if (!packet.min_square.empty()) {
+                found_counter.fetch_add(1, std::memory_order_relaxed);
+                char text[64];
+                snprintf(text, sizeof(text), "edge: %.2f px", squareEdgeLength(packet.min_square));
+                cv::putText(packet.result_image, text, cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.8,
+                            cv::Scalar(0, 0, 255), 2);
+            }
+
+            for (size_t i = 0; i < packet.digits.size(); ++i) {
+                if (packet.digits[i].digit >= 0) {
+                    digit_counter.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            // 结果图像交出后不再修改
+            if (recorder) {
+                recorder->record(packet);
+                // 异常：稳定识别的目标突然丢失，或单帧延迟超过1秒
+                if (!packet.min_square.empty()) {
+                    ++found_streak;
+                } else {
+                    if (found_streak >= 10) {
+                        recorder->trigger("target_lost");
+                    }
+                    found_streak = 0;
+                }
+                if (output_us - packet.capture_us > 1000000) {
+                    recorder->trigger("slow_frame");
+                }
+            }
+            if (preview_port > 0) {
+                preview.publish(packet.result_image);
+                preview_dropped_counter.store(preview.droppedFrames(), std::memory_order_relaxed);
+            }
+            if (!headless) {
+                gui_mailbox.put(std::move(packet));
+                gui_dropped_counter.store(gui_mailbox.dropped(), std::memory_order_relaxed);
+            }
+        }
+        sink_done = true;
+        gui_mailbox.close();
+    });
+
+    // 主线程：有界面时显示最新结果，无界面时只等待退出信号
+    while (!g_quit && !sink_done) {
+        if (headless) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+
+        FramePacket packet;
+        if (gui_mailbox.take(packet, 30)) {
+            int64_t display_start_us = captureNowMicros();
+            cv::imshow("原始图像", packet.frame);
+            cv::imshow("识别结果", packet.result_image);
+            display_hist.record(captureNowMicros() - display_start_us);
         }
 
         // 按下 'q' 键退出
         if (cv::waitKey(1) == 'q') {
-            running = false;
+            break;
         }
     }
 
+    pipeline.stop();
+    sink_thread.join();
+    preview.stop();
+    if (recorder) {
+        recorder->stop();
+    }
+    stats.stopPeriodicDump();
+    stats.report(std::cout);
     std::cout << "程序退出" << std::endl;
-    cv::destroyAllWindows();
+    if (!headless) {
+        cv::destroyAllWindows();
+    }
     return 0;
-}
\ No newline at end of file
+}
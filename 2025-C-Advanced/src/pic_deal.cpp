@@ -1,14 +1,85 @@
 #include "pic_deal.h"
+#include "yuv_luma.h"
 #include <iostream>
 
-PicDeal::PicDeal() : is_camera_open_(false) {
+namespace {
+
+// 把采集帧转换为 BGR 图像；can_share 为 true 时允许直接引用不会被覆盖的源数据
+void frameToBgr(const CaptureFrame& frame, cv::Mat& bgr, bool can_share) {
+    switch (frame.format) {
+        case PixelFormat::YUYV:
+            cv::cvtColor(frame.image, bgr, cv::COLOR_YUV2BGR_YUYV);
+            break;
+        case PixelFormat::NV12:
+            cv::cvtColor(frame.image, bgr, cv::COLOR_YUV2BGR_NV12);
+            break;
+        case PixelFormat::GRAY:
+            cv::cvtColor(frame.image, bgr, cv::COLOR_GRAY2BGR);
+            break;
+        case PixelFormat::BGR:
+        default:
+            if (can_share) {
+                bgr = frame.image;
+            } else {
+                frame.image.copyTo(bgr);
+            }
+            break;
+    }
+}
+
+// 把采集帧转换为单通道亮度图像；can_share 为 true 时允许直接引用不会被覆盖的源数据
+void frameToGray(const CaptureFrame& frame, cv::Mat& gray, bool can_share) {
+    switch (frame.format) {
+        case PixelFormat::YUYV:
+            gray.create(frame.image.rows, frame.image.cols, CV_8UC1);
+            extractLumaYuyv(frame.image.data, frame.image.step, gray.data, gray.step,
+                            frame.image.cols, frame.image.rows);
+            break;
+        case PixelFormat::NV12:
+        case PixelFormat::GRAY: {
+            // NV12 的前 2/3 行即为 Y 平面
+            cv::Mat luma = frame.format == PixelFormat::NV12
+                               ? frame.image.rowRange(0, frame.image.rows * 2 / 3)
+                               : frame.image;
+            if (can_share) {
+                gray = luma;
+            } else {
+                luma.copyTo(gray);
+            }
+            break;
+        }
+        case PixelFormat::BGR:
+        default:
+            cv::cvtColor(frame.image, gray, cv::COLOR_BGR2GRAY);
+            break;
+    }
+}
+
+// 缓存缓冲区仍被调用者持有时先断开引用，保证重新计算时分配新内存而不是覆盖调用者手中的结果；
+// 无人持有时保留原缓冲区，下次计算直接复用
+void detachIfShared(cv::Mat& buffer) {
+    if (buffer.u && buffer.u->refcount > 1) {
+        buffer.release();
+    }
+}
+
+} // namespace
+
+PicDeal::PicDeal()
+    : generation_(1),
+      source_data_(nullptr),
+      is_camera_open_(false),
+      capture_mode_(CaptureMode::BGR),
+      has_last_sequence_(false),
+      last_sequence_(0),
+      dropped_frames_(0) {
     // 构造函数初始化
 }
 
 PicDeal::~PicDeal() {
     // 析构函数清理
-    if (is_camera_open_) {
-        camera_.release();
+    if (capture_) {
+        capture_->close();
     }
 }
 
@@ -18,33 +89,47 @@ bool PicDeal::readImage(const std::string& img_path) {
         std::cerr << "无法读取图像: " << img_path << std::endl;
         return false;
     }
+    invalidateCache();
     return true;
 }
 
 bool PicDeal::readFromCamera(int camera_id) {
-    if (is_camera_open_) {
-        camera_.release();
+    return openCapture(std::unique_ptr<CaptureBackend>(new OpenCvCapture(camera_id)));
+}
+
+bool PicDeal::openCapture(std::unique_ptr<CaptureBackend> backend) {
+    if (capture_) {
+        capture_->close();
+        capture_.reset();
     }
+    is_camera_open_ = false;
 
-    camera_.open(camera_id);
-    if (!camera_.isOpened()) {
-        std::cerr << "无法打开摄像头: " << camera_id << std::endl;
-        is_camera_open_ = false;
+    if (!backend || !backend->open()) {
         return false;
     }
+    capture_ = std::move(backend);
+    is_camera_open_ = true;
+    has_last_sequence_ = false;
 
     // 读取一帧图像以确保摄像头正常工作
-    if (!camera_.read(current_image_)) {
+    if (getCurrentImage().empty()) {
         std::cerr << "无法从摄像头读取图像" << std::endl;
-        camera_.release();
+        capture_->close();
+        capture_.reset();
         is_camera_open_ = false;
         return false;
     }
-
-    is_camera_open_ = true;
     return true;
 }
 
+void PicDeal::setCaptureMode(CaptureMode mode) {
+    capture_mode_ = mode;
+}
+
+CaptureMode PicDeal::getCaptureMode() const {
+    return capture_mode_;
+}
+
 bool PicDeal::saveImage(const std::string& img_path) {
     if (current_image_.empty()) {
         std::cerr << "没有图像可保存" << std::endl;
@@ -58,9 +143,16 @@ cv::Mat PicDeal::toGrayscale() {
         std::cerr << "没有图像可处理" << std::endl;
         return cv::Mat();
     }
-    cv::Mat gray_img;
-    cv::cvtColor(current_image_, gray_img, cv::COLOR_BGR2GRAY);
-    return gray_img;
+    return cachedGray();
+}
+
+bool PicDeal::toGrayscale(cv::Mat& gray) {
+    if (current_image_.empty()) {
+        std::cerr << "没有图像可处理" << std::endl;
+        return false;
+    }
+    cachedGray().copyTo(gray);
+    return true;
 }
 
 cv::Mat PicDeal::binarize(int threshold) {
@@ -68,10 +160,16 @@ cv::Mat PicDeal::binarize(int threshold) {
         std::cerr << "没有图像可处理" << std::endl;
         return cv::Mat();
     }
-    cv::Mat gray_img = toGrayscale();
-    cv::Mat binary_img;
-    cv::threshold(gray_img, binary_img, threshold, 255, cv::THRESH_BINARY);
-    return binary_img;
+    return cachedBinary(threshold);
+}
+
+bool PicDeal::binarize(int threshold, cv::Mat& binary) {
+    if (current_image_.empty()) {
+        std::cerr << "没有图像可处理" << std::endl;
+        return false;
+    }
+    cachedBinary(threshold).copyTo(binary);
+    return true;
 }
 
 cv::Mat PicDeal::edgeDetection(int low_threshold, int high_threshold) {
@@ -79,12 +177,16 @@ cv::Mat PicDeal::edgeDetection(int low_threshold, int high_threshold) {
         std::cerr << "没有图像可处理" << std::endl;
         return cv::Mat();
     }
-    cv::Mat gray_img = toGrayscale();
-    cv::Mat blurred_img;
-    cv::GaussianBlur(gray_img, blurred_img, cv::Size(3, 3), 0);
-    cv::Mat edges;
-    cv::Canny(blurred_img, edges, low_threshold, high_threshold);
-    return edges;
+    return cachedEdges(low_threshold, high_threshold);
+}
+
+bool PicDeal::edgeDetection(int low_threshold, int high_threshold, cv::Mat& edges) {
+    if (current_image_.empty()) {
+        std::cerr << "没有图像可处理" << std::endl;
+        return false;
+    }
+    cachedEdges(low_threshold, high_threshold).copyTo(edges);
+    return true;
 }
 
 bool PicDeal::findContours(std::vector<std::vector<cv::Point>>& contours, std::vector<cv::Vec4i>& hierarchy) {
@@ -93,14 +195,119 @@ bool PicDeal::findContours(std::vector<std::vector<cv::Point>>& contours, std::v
         return false;
     }
 
-    cv::Mat edges = edgeDetection(50, 150);
-    cv::findContours(edges, contours, hierarchy, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+    // findContours 不修改输入，可以直接使用缓存的边缘图
+    cv::findContours(cachedEdges(50, 150), contours, hierarchy, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
     return !contours.empty();
 }
 
+void PicDeal::invalidateCache() {
+    ++generation_;
+    source_data_ = current_image_.data;
+}
+
+void PicDeal::syncGeneration() {
+    if (current_image_.data != source_data_) {
+        invalidateCache();
+    }
+}
+
+const cv::Mat& PicDeal::cachedGray() {
+    syncGeneration();
+    if (cache_.gray_generation != generation_) {
+        if (current_image_.channels() == 1) {
+            // 已是单通道，直接共享当前图像
+            cache_.gray = current_image_;
+        } else {
+            detachIfShared(cache_.gray);
+            cv::cvtColor(current_image_, cache_.gray, cv::COLOR_BGR2GRAY);
+        }
+        cache_.gray_generation = generation_;
+    }
+    return cache_.gray;
+}
+
+const cv::Mat& PicDeal::cachedBlurred() {
+    const cv::Mat& gray = cachedGray();
+    if (cache_.blurred_generation != generation_) {
+        detachIfShared(cache_.blurred);
+        cv::GaussianBlur(gray, cache_.blurred, cv::Size(3, 3), 0);
+        cache_.blurred_generation = generation_;
+    }
+    return cache_.blurred;
+}
+
+const cv::Mat& PicDeal::cachedEdges(int low_threshold, int high_threshold) {
+    const cv::Mat& blurred = cachedBlurred();
+    if (cache_.edges_generation != generation_ || cache_.edges_low != low_threshold ||
+        cache_.edges_high != high_threshold) {
+        detachIfShared(cache_.edges);
+        cv::Canny(blurred, cache_.edges, low_threshold, high_threshold);
+        cache_.edges_generation = generation_;
+        cache_.edges_low = low_threshold;
+        cache_.edges_high = high_threshold;
+    }
+    return cache_.edges;
+}
+
+const cv::Mat& PicDeal::cachedBinary(int threshold) {
+    const cv::Mat& gray = cachedGray();
+    if (cache_.binary_generation != generation_ || cache_.binary_threshold != threshold) {
+        detachIfShared(cache_.binary);
+        cv::threshold(gray, cache_.binary, threshold, 255, cv::THRESH_BINARY);
+        cache_.binary_generation = generation_;
+        cache_.binary_threshold = threshold;
+    }
+    return cache_.binary;
+}
+
 cv::Mat& PicDeal::getCurrentImage() {
     if (is_camera_open_) {
-        camera_.read(current_image_);
+        CaptureFrame frame;
+        if (capture_->grab(frame)) {
+            // 返回的是可修改的引用，不能与后端共享缓冲区
+            if (capture_mode_ == CaptureMode::LUMA) {
+                frameToGray(frame, current_image_, !frame.read_only);
+            } else {
+                frameToBgr(frame, current_image_, !frame.read_only);
+            }
+            invalidateCache();
+        }
     }
     return current_image_;
-}
\ No newline at end of file
+}
+
+bool PicDeal::readFrame(cv::Mat& frame) {
+    CaptureFrame captured;
+    if (!grabFrame(captured)) {
+        return false;
+    }
+
+    // 帧序号不连续说明中间有帧被驱动丢弃
+    if (has_last_sequence_ && captured.sequence > last_sequence_ + 1) {
+        dropped_frames_.fetch_add(captured.sequence - last_sequence_ - 1, std::memory_order_relaxed);
+    }
+    has_last_sequence_ = true;
+    last_sequence_ = captured.sequence;
+
+    // 先释放对旧缓冲区的引用，保证转换结果写入新的缓冲区而不是覆盖仍在使用的帧；
+    // 没有租约的只读帧（如内存中的回放图片）不会被覆盖，可以直接共享
+    frame.release();
+    if (capture_mode_ == CaptureMode::LUMA) {
+        frameToGray(captured, frame, !captured.lease);
+    } else {
+        frameToBgr(captured, frame, !captured.lease);
+    }
+    return true;
+}
+
+bool PicDeal::grabFrame(CaptureFrame& frame) {
+    if (!is_camera_open_) {
+        std::cerr << "摄像头未打开" << std::endl;
+        return false;
+    }
+    return capture_->grab(frame);
+}
+
+uint64_t PicDeal::droppedFrames() const {
+    return dropped_frames_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,267 @@
+#include "preview_server.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+namespace {
+
+// HTTP 响应头，之后每帧以 --frame 分隔
+const char kResponseHeader[] =
+    "HTTP/1.0 200 OK\r\n"
+    "Cache-Control: no-cache, no-store\r\n"
+    "Pragma: no-cache\r\n"
+    "Connection: close\r\n"
+    "Content-Type: multipart/x-mixed-replace; boundary=frame\r\n"
+    "\r\n";
+
+} // namespace
+
+PreviewServer::PreviewServer(int port, int jpeg_quality, const std::string& bind_address)
+    : port_(port),
+      jpeg_quality_(jpeg_quality),
+      bind_address_(bind_address),
+      listen_fd_(-1),
+      running_(false),
+      jpeg_generation_(0) {
+    // 构造函数初始化
+}
+
+PreviewServer::~PreviewServer() {
+    // 析构函数停止服务
+    stop();
+}
+
+bool PreviewServer::start() {
+    if (running_) {
+        return true;
+    }
+
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "无法创建预览服务套接字: " << strerror(errno) << std::endl;
+        return false;
+    }
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port_));
+    if (inet_pton(AF_INET, bind_address_.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "无效的预览服务地址: " << bind_address_ << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(listen_fd_, 4) < 0) {
+        std::cerr << "预览服务无法监听 " << bind_address_ << ":" << port_ << ": " << strerror(errno) << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    running_ = true;
+    pending_.reopen();
+    accept_thread_ = std::thread(&PreviewServer::acceptThread, this);
+    encode_thread_ = std::thread(&PreviewServer::encodeThread, this);
+    std::cout << "预览服务已启动: http://" << bind_address_ << ":" << port_ << "/" << std::endl;
+    return true;
+}
+
+void PreviewServer::stop() {
+    if (!running_.exchange(false)) {
+        return;
+    }
+
+    // 唤醒编码线程和所有客户端线程
+    pending_.close();
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        jpeg_ready_.notify_all();
+        for (size_t i = 0; i < clients_.size(); ++i) {
+            shutdown(clients_[i]->fd, SHUT_RDWR);
+        }
+    }
+
+    if (accept_thread_.joinable()) {
+        accept_thread_.join();
+    }
+    if (encode_thread_.joinable()) {
+        encode_thread_.join();
+    }
+
+    // 监听线程已退出，不会再有新客户端
+    std::vector<std::unique_ptr<Client>> clients;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        clients.swap(clients_);
+    }
+    for (size_t i = 0; i < clients.size(); ++i) {
+        if (clients[i]->thread.joinable()) {
+            clients[i]->thread.join();
+        }
+        ::close(clients[i]->fd);
+    }
+
+    ::close(listen_fd_);
+    listen_fd_ = -1;
+}
+
+void PreviewServer::publish(const cv::Mat& image) {
+    if (running_ && !image.empty()) {
+        pending_.put(image);
+    }
+}
+
+uint64_t PreviewServer::droppedFrames() const {
+    return pending_.dropped();
+}
+
+size_t PreviewServer::clientCount() const {
+    std::lock_guard<std::mutex> lock(clients_mutex_);
+    size_t count = 0;
+    for (size_t i = 0; i < clients_.size(); ++i) {
+        if (!clients_[i]->finished) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+void PreviewServer::acceptThread() {
+    while (running_) {
+        // 定期超时以便检查停止标志，并回收已断开的客户端
+        pollfd pfd;
+        pfd.fd = listen_fd_;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        int ret = poll(&pfd, 1, 200);
+        reapClients();
+        if (ret <= 0) {
+            continue;
+        }
+
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        if (!running_) {
+            ::close(fd);
+            break;
+        }
+        std::unique_ptr<Client> client(new Client());
+        client->fd = fd;
+        client->thread = std::thread(&PreviewServer::clientThread, this, client.get());
+        clients_.push_back(std::move(client));
+    }
+}
+
+void PreviewServer::reapClients() {
+    std::vector<std::unique_ptr<Client>> finished;
+    {
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        for (size_t i = 0; i < clients_.size();) {
+            if (clients_[i]->finished) {
+                finished.push_back(std::move(clients_[i]));
+                clients_[i] = std::move(clients_.back());
+                clients_.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+    for (size_t i = 0; i < finished.size(); ++i) {
+        finished[i]->thread.join();
+        ::close(finished[i]->fd);
+    }
+}
+
+void PreviewServer::encodeThread() {
+    std::vector<int> params;
+    params.push_back(cv::IMWRITE_JPEG_QUALITY);
+    params.push_back(jpeg_quality_);
+
+    cv::Mat image;
+    while (pending_.take(image)) {
+        // 没有客户端时不编码，只丢弃
+        if (clientCount() == 0) {
+            continue;
+        }
+
+        std::shared_ptr<std::vector<uchar>> jpeg(new std::vector<uchar>());
+        if (!cv::imencode(".jpg", image, *jpeg, params)) {
+            continue;
+        }
+        image.release();
+
+        std::lock_guard<std::mutex> lock(clients_mutex_);
+        latest_jpeg_ = jpeg;
+        ++jpeg_generation_;
+        jpeg_ready_.notify_all();
+    }
+}
+
+void PreviewServer::clientThread(Client* client) {
+    int fd = client->fd;
+
+    // 读取并丢弃请求头，任何路径都返回视频流
+    char request[1024];
+    pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, 1000) > 0) {
+        ssize_t ignored = recv(fd, request, sizeof(request), 0);
+        (void)ignored;
+    }
+
+    bool ok = sendAll(fd, kResponseHeader, sizeof(kResponseHeader) - 1);
+    uint64_t sent_generation = 0;
+    while (ok && running_) {
+        // 等待比上次发送更新的编码结果，中间错过的帧直接跳过
+        std::shared_ptr<const std::vector<uchar>> jpeg;
+        {
+            std::unique_lock<std::mutex> lock(clients_mutex_);
+            jpeg_ready_.wait(lock, [this, sent_generation]() {
+                return !running_ || jpeg_generation_ != sent_generation;
+            });
+            if (!running_) {
+                break;
+            }
+            jpeg = latest_jpeg_;
+            sent_generation = jpeg_generation_;
+        }
+
+        char part_header[128];
+        int length = snprintf(part_header, sizeof(part_header),
+                              "--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %zu\r\n\r\n", jpeg->size());
+        ok = sendAll(fd, part_header, static_cast<size_t>(length)) && sendAll(fd, jpeg->data(), jpeg->size()) &&
+             sendAll(fd, "\r\n", 2);
+    }
+
+    client->finished = true;
+}
+
+bool PreviewServer::sendAll(int fd, const void* data, size_t size) {
+    const char* ptr = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = send(fd, ptr, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        ptr += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
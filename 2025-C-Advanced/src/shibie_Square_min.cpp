@@ -1,19 +1,39 @@
-#include <opencv2/opencv.hpp>
-#include <vector>
+#include "shibie_Square_min.h"
+#include "thread_deal.h"
 #include <algorithm>
 #include <iostream>
+#include <cfloat>
+#include <cmath>
 
-/**
- * 识别图像中的正方形，处理重叠情况，并找出最小的正方形
- * @param image 输入图像
- * @param result_image 输出结果图像
- * @param min_square 输出最小正方形的顶点
- */
-void shibie_Square_min(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square) {
-    // 创建灰度图像
-    cv::Mat gray;
-    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+namespace {
+
+const float kTileMargin = 3.0f; // 模糊核半径加边缘检测的余量，距分块内侧边界小于它的轮廓可能被截断
+const float kCoarseMinSquare = 32.0f; // 整幅图像检测的降采样层上，正方形至少保留的边长（像素）
+
+// 包围盒的较长边
+float boxSide(const std::vector<cv::Point2f>& square) {
+    float x0 = FLT_MAX, y0 = FLT_MAX, x1 = -FLT_MAX, y1 = -FLT_MAX;
+    for (const auto& point : square) {
+        x0 = std::min(x0, point.x);
+        y0 = std::min(y0, point.y);
+        x1 = std::max(x1, point.x);
+        y1 = std::max(y1, point.y);
+    }
+    return std::max(x1 - x0, y1 - y0);
+}
+
+// 顶点的平均位置
+cv::Point2f squareCenter(const std::vector<cv::Point2f>& square) {
+    cv::Point2f center(0, 0);
+    for (const auto& point : square) {
+        center += point;
+    }
+    return center * (1.0f / square.size());
+}
 
+} // namespace
+
+void findSquareCandidates(const cv::Mat& gray, std::vector<std::vector<cv::Point2f>>& squares, cv::Point offset) {
     // 高斯模糊
     cv::Mat blurred;
     cv::GaussianBlur(gray, blurred, cv::Size(5, 5), 0);
@@ -27,9 +47,11 @@ void shibie_Square_min(const cv::Mat& image, cv::Mat& result_image, std::vector<
     std::vector<cv::Vec4i> hierarchy;
     cv::findContours(edges, contours, hierarchy, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
 
-    // 存储所有检测到的正方形
-    std::vector<std::vector<cv::Point2f>> squares;
+    fitSquaresFromContours(contours, squares, offset);
+}
 
+void fitSquaresFromContours(const std::vector<std::vector<cv::Point>>& contours,
+                            std::vector<std::vector<cv::Point2f>>& squares, cv::Point offset) {
     // 处理每个轮廓
     for (size_t i = 0; i < contours.size(); i++) {
         // 多边形近似
@@ -63,76 +85,397 @@ void shibie_Square_min(const cv::Mat& image, cv::Mat& result_image, std::vector<
                     // 转换为Point2f
                     std::vector<cv::Point2f> square;
                     for (const auto& point : approx) {
-                        square.push_back(cv::Point2f(point));
+                        square.push_back(cv::Point2f(point + offset));
                     }
                     squares.push_back(square);
+                }
+            }
+        }
+    }
+}
+
+void findSquareCandidatesTiled(const cv::Mat& gray, std::vector<std::vector<cv::Point2f>>& squares, ThreadPool& pool,
+                               int tile_size, int overlap) {
+    if (tile_size <= 0 || (gray.cols <= tile_size && gray.rows <= tile_size)) {
+        findSquareCandidates(gray, squares);
+        return;
+    }
+    overlap = std::max(overlap, 0);
+
+    // 包围盒边长不超过 max_tile_side 的正方形，中心点所在分块的检测区域一定完整包含它，由分块检测；
+    // 更大的正方形可能跨越任意分块的接缝，改由降采样后的整幅图像检测，降采样倍率取到
+    // 刚超过阈值的正方形仍保留 kCoarseMinSquare 像素为止
+    float max_tile_side = 2.0f * (overlap - kTileMargin - 1.0f);
+    int coarse_scale = 1;
+    while (coarse_scale * 2 * kCoarseMinSquare <= max_tile_side) {
+        coarse_scale *= 2;
+    }
+    // 两部分的尺寸测量都有误差（整幅图像检测约为一个降采样像素），阈值附近的正方形两边都保留，合并时去重
+    float band = 2.0f * coarse_scale;
+
+    int tiles_x = (gray.cols + tile_size - 1) / tile_size;
+    int tiles_y = (gray.rows + tile_size - 1) / tile_size;
+    size_t tile_count = static_cast<size_t>(tiles_x) * tiles_y;
+    std::vector<std::vector<std::vector<cv::Point2f>>> tile_squares(tile_count);
+    std::vector<std::vector<cv::Point2f>> coarse_squares;
+    cv::Rect image_rect(0, 0, gray.cols, gray.rows);
 
-                    // 在结果图像上绘制轮廓
-                    cv::polylines(result_image, approx, true, cv::Scalar(0, 255, 0), 2);
+    // 最后一个任务是整幅图像检测，与各分块并行执行
+    pool.parallelFor(0, tile_count + 1, [&](size_t tile_begin, size_t tile_end) {
+        for (size_t t = tile_begin; t < tile_end; t++) {
+            if (t == tile_count) {
+                cv::Mat coarse = gray;
+                if (coarse_scale > 1) {
+                    cv::resize(gray, coarse, cv::Size(), 1.0 / coarse_scale, 1.0 / coarse_scale, cv::INTER_AREA);
+                }
+                std::vector<std::vector<cv::Point2f>> candidates;
+                findSquareCandidates(coarse, candidates);
+
+                // 降采样像素 i 覆盖原图 [i*s, (i+1)*s)，坐标换算到其中心
+                float offset = (coarse_scale - 1) * 0.5f;
+                for (size_t i = 0; i < candidates.size(); i++) {
+                    for (auto& point : candidates[i]) {
+                        point = point * static_cast<float>(coarse_scale) + cv::Point2f(offset, offset);
+                    }
+                    if (boxSide(candidates[i]) > max_tile_side - band) {
+                        coarse_squares.push_back(candidates[i]);
+                    }
+                }
+                continue;
+            }
+
+            // 分块的核心区域，以及向四周扩展重叠宽度后的检测区域
+            int tx = static_cast<int>(t) % tiles_x;
+            int ty = static_cast<int>(t) / tiles_x;
+            cv::Rect core(tx * tile_size, ty * tile_size, tile_size, tile_size);
+            core &= image_rect;
+            cv::Rect roi(core.x - overlap, core.y - overlap, core.width + 2 * overlap, core.height + 2 * overlap);
+            roi &= image_rect;
+
+            std::vector<std::vector<cv::Point2f>> candidates;
+            findSquareCandidates(gray(roi), candidates, roi.tl());
+
+            // 距内侧边界小于余量的轮廓可能被截断
+            float left = roi.x > 0 ? roi.x + kTileMargin : -FLT_MAX;
+            float top = roi.y > 0 ? roi.y + kTileMargin : -FLT_MAX;
+            float right = roi.x + roi.width < gray.cols ? roi.x + roi.width - 1 - kTileMargin : FLT_MAX;
+            float bottom = roi.y + roi.height < gray.rows ? roi.y + roi.height - 1 - kTileMargin : FLT_MAX;
+
+            for (size_t i = 0; i < candidates.size(); i++) {
+                bool clipped = false;
+                for (const auto& point : candidates[i]) {
+                    if (point.x < left || point.x > right || point.y < top || point.y > bottom) {
+                        clipped = true;
+                        break;
+                    }
+                }
+                if (clipped || boxSide(candidates[i]) > max_tile_side) {
+                    continue;
+                }
+
+                // 只保留中心点落在本块核心区域内的正方形，相邻块的重复结果自然被去除
+                cv::Point2f center = squareCenter(candidates[i]);
+                if (center.x >= core.x && center.x < core.x + core.width &&
+                    center.y >= core.y && center.y < core.y + core.height) {
+                    tile_squares[t].push_back(candidates[i]);
                 }
             }
         }
+    });
+
+    // 按分块顺序合并，再追加整幅图像检测的结果
+    size_t first = squares.size();
+    for (size_t t = 0; t < tile_count; t++) {
+        squares.insert(squares.end(), tile_squares[t].begin(), tile_squares[t].end());
     }
+    size_t tiled_end = squares.size();
+
+    // 阈值附近的正方形可能被两部分同时检测到：中心和尺寸都在误差范围内时视为同一个，保留分块的精确结果
+    for (size_t i = 0; i < coarse_squares.size(); i++) {
+        float side = boxSide(coarse_squares[i]);
+        bool duplicate = false;
+        if (side <= max_tile_side + band) {
+            cv::Point2f center = squareCenter(coarse_squares[i]);
+            for (size_t j = first; j < tiled_end && !duplicate; j++) {
+                cv::Point2f shift = squareCenter(squares[j]) - center;
+                duplicate = std::fabs(shift.x) <= band && std::fabs(shift.y) <= band &&
+                            std::fabs(boxSide(squares[j]) - side) <= 2 * band;
+            }
+        }
+        if (!duplicate) {
+            squares.push_back(coarse_squares[i]);
+        }
+    }
+}
+
+int findSquareCandidatesPyramid(const cv::Mat& gray, std::vector<std::vector<cv::Point2f>>& squares,
+                                const SquareDetectOptions& options) {
+    // 逐层降采样，太小时提前停止
+    cv::Mat level = gray;
+    int scale = 1;
+    for (int i = 0; i < options.pyramid_levels && level.cols >= 64 && level.rows >= 64; i++) {
+        cv::Mat down;
+        cv::pyrDown(level, down);
+        level = down;
+        scale *= 2;
+    }
+
+    // 在低分辨率图像上检测，分块参数同样换算到该层
+    size_t first = squares.size();
+    if (options.pool && options.tile_size > 0) {
+        findSquareCandidatesTiled(level, squares, *options.pool, std::max(options.tile_size / scale, 32),
+                                  options.tile_overlap / scale);
+    } else {
+        findSquareCandidates(level, squares);
+    }
+
+    // 坐标乘回原图尺度
+    if (scale > 1) {
+        for (size_t i = first; i < squares.size(); i++) {
+            for (auto& point : squares[i]) {
+                point *= static_cast<float>(scale);
+            }
+        }
+    }
+    return scale;
+}
+
+void refineSquareCorners(const cv::Mat& gray, std::vector<std::vector<cv::Point2f>>& squares, int scale) {
+    cv::TermCriteria criteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 20, 0.01);
 
-    // 处理重叠正方形
-    // 这里简化处理，仅保留不重叠或面积较大的正方形
-    std::vector<std::vector<cv::Point2f>> non_overlapping_squares;
     for (size_t i = 0; i < squares.size(); i++) {
+        std::vector<cv::Point2f>& square = squares[i];
+
+        // 窗口需覆盖粗定位误差，但不能超过边长的1/4，以免混入相邻顶点
+        double edge = squareEdgeLength(square);
+        int half_window = std::min(2 * scale + 1, static_cast<int>(edge / 4));
+        if (half_window < 2) {
+            continue;
+        }
+
+        std::vector<cv::Point2f> refined = square;
+        cv::cornerSubPix(gray, refined, cv::Size(half_window, half_window), cv::Size(-1, -1), criteria);
+
+        // 精化结果偏离窗口时认为失败，保留原顶点
+        for (size_t j = 0; j < square.size(); j++) {
+            cv::Point2f shift = refined[j] - square[j];
+            if (std::fabs(shift.x) <= half_window && std::fabs(shift.y) <= half_window) {
+                square[j] = refined[j];
+            }
+        }
+    }
+}
+
+double squareEdgeLength(const std::vector<cv::Point2f>& square) {
+    if (square.size() < 4) {
+        return 0;
+    }
+    double sum = 0;
+    for (size_t i = 0; i < 4; i++) {
+        sum += cv::norm(square[i] - square[(i + 1) % 4]);
+    }
+    return sum / 4;
+}
+
+void filterOverlappingSquares(const std::vector<std::vector<cv::Point2f>>& squares,
+                              std::vector<std::vector<cv::Point2f>>& non_overlapping_squares,
+                              std::vector<double>* areas) {
+    // 仅保留不被更大正方形（面积大于1.5倍）完全包含的正方形
+    size_t count = squares.size();
+    if (count == 0) {
+        return;
+    }
+
+    // 每个候选的面积和包围盒只计算一次
+    std::vector<double> candidate_areas(count);
+    std::vector<cv::Rect2f> boxes(count);
+    float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+    double size_sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        candidate_areas[i] = cv::contourArea(squares[i]);
+        float x0 = FLT_MAX, y0 = FLT_MAX, x1 = -FLT_MAX, y1 = -FLT_MAX;
+        for (const auto& point : squares[i]) {
+            x0 = std::min(x0, point.x);
+            y0 = std::min(y0, point.y);
+            x1 = std::max(x1, point.x);
+            y1 = std::max(y1, point.y);
+        }
+        boxes[i] = cv::Rect2f(x0, y0, x1 - x0, y1 - y0);
+        min_x = std::min(min_x, x0);
+        min_y = std::min(min_y, y0);
+        max_x = std::max(max_x, x1);
+        max_y = std::max(max_y, y1);
+        size_sum += std::max(x1 - x0, y1 - y0);
+    }
+
+    // 建立均匀网格索引：每个正方形登记到其包围盒覆盖的所有格子中
+    // 格子边长取平均边长，格子总数限制在候选数的常数倍以内
+    float cell = std::max(16.0f, static_cast<float>(size_sum / count));
+    int grid_w = static_cast<int>((max_x - min_x) / cell) + 1;
+    int grid_h = static_cast<int>((max_y - min_y) / cell) + 1;
+    while (static_cast<size_t>(grid_w) * grid_h > 4 * count + 64) {
+        cell *= 2;
+        grid_w = static_cast<int>((max_x - min_x) / cell) + 1;
+        grid_h = static_cast<int>((max_y - min_y) / cell) + 1;
+    }
+    std::vector<std::vector<int>> grid(static_cast<size_t>(grid_w) * grid_h);
+    for (size_t j = 0; j < count; j++) {
+        int cx0 = static_cast<int>((boxes[j].x - min_x) / cell);
+        int cy0 = static_cast<int>((boxes[j].y - min_y) / cell);
+        int cx1 = static_cast<int>((boxes[j].x + boxes[j].width - min_x) / cell);
+        int cy1 = static_cast<int>((boxes[j].y + boxes[j].height - min_y) / cell);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                grid[cy * grid_w + cx].push_back(static_cast<int>(j));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
         bool is_overlapping = false;
-        double area_i = cv::contourArea(squares[i]);
+        double area_i = candidate_areas[i];
+        const cv::Rect2f& box_i = boxes[i];
 
-        for (size_t j = 0; j < squares.size(); j++) {
+        // 能包含i的正方形必然覆盖i的第一个顶点，只需检查该顶点所在格子中的候选
+        const cv::Point2f& anchor = squares[i][0];
+        int cx = static_cast<int>((anchor.x - min_x) / cell);
+        int cy = static_cast<int>((anchor.y - min_y) / cell);
+        const std::vector<int>& nearby = grid[cy * grid_w + cx];
+
+        for (size_t k = 0; k < nearby.size(); k++) {
+            size_t j = static_cast<size_t>(nearby[k]);
             if (i == j) continue;
 
-            double area_j = cv::contourArea(squares[j]);
             // 如果j的面积比i大很多，且i在j内部，则认为i是j的内部轮廓
-            if (area_j > 1.5 * area_i) {
-                // 检查i是否在j内部
-                bool all_inside = true;
-                for (const auto& point : squares[i]) {
-                    double dist = cv::pointPolygonTest(squares[j], point, false);
-                    if (dist < 0) {
-                        all_inside = false;
-                        break;
-                    }
-                }
-                if (all_inside) {
-                    is_overlapping = true;
+            if (candidate_areas[j] <= 1.5 * area_i) continue;
+
+            // 包围盒不包含时不可能完全在内部，跳过精确检查
+            const cv::Rect2f& box_j = boxes[j];
+            if (box_i.x < box_j.x || box_i.y < box_j.y ||
+                box_i.x + box_i.width > box_j.x + box_j.width ||
+                box_i.y + box_i.height > box_j.y + box_j.height) {
+                continue;
+            }
+
+            // 检查i是否在j内部
+            bool all_inside = true;
+            for (const auto& point : squares[i]) {
+                double dist = cv::pointPolygonTest(squares[j], point, false);
+                if (dist < 0) {
+                    all_inside = false;
                     break;
                 }
             }
+            if (all_inside) {
+                is_overlapping = true;
+                break;
+            }
         }
 
         if (!is_overlapping) {
             non_overlapping_squares.push_back(squares[i]);
+            if (areas) {
+                areas->push_back(area_i);
+            }
         }
     }
+}
 
-    // 找出最小的正方形
-    if (!non_overlapping_squares.empty()) {
-        size_t min_index = 0;
-        double min_area = cv::contourArea(non_overlapping_squares[0]);
-
-        for (size_t i = 1; i < non_overlapping_squares.size(); i++) {
-            double area = cv::contourArea(non_overlapping_squares[i]);
-            if (area < min_area) {
-                min_area = area;
-                min_index = i;
-            }
+bool findMinSquare(const std::vector<std::vector<cv::Point2f>>& squares, std::vector<cv::Point2f>& min_square,
+                   const std::vector<double>* areas) {
+    if (squares.empty()) {
+        return false;
+    }
+
+    // 有预先计算的面积时直接使用
+    size_t min_index = 0;
+    double min_area = areas ? (*areas)[0] : cv::contourArea(squares[0]);
+
+    for (size_t i = 1; i < squares.size(); i++) {
+        double area = areas ? (*areas)[i] : cv::contourArea(squares[i]);
+        if (area < min_area) {
+            min_area = area;
+            min_index = i;
         }
+    }
 
-        // 存储最小正方形
-        min_square = non_overlapping_squares[min_index];
+    // 存储最小正方形
+    min_square = squares[min_index];
+    return true;
+}
 
-        // 在结果图像上绘制最小正方形（红色）
-        std::vector<cv::Point> min_square_points;
-        for (const auto& point : min_square) {
-            min_square_points.push_back(cv::Point(point));
+void drawSquareResult(cv::Mat& result_image, const std::vector<std::vector<cv::Point2f>>& squares,
+                      const std::vector<cv::Point2f>& min_square) {
+    // 在结果图像上绘制所有正方形（绿色）
+    for (size_t i = 0; i < squares.size(); i++) {
+        std::vector<cv::Point> points;
+        for (const auto& point : squares[i]) {
+            points.push_back(cv::Point(point));
         }
-        cv::polylines(result_image, min_square_points, true, cv::Scalar(0, 0, 255), 3);
+        cv::polylines(result_image, points, true, cv::Scalar(0, 255, 0), 2);
+    }
+
+    if (min_square.empty()) {
+        return;
+    }
+
+    // 在结果图像上绘制最小正方形（红色）
+    std::vector<cv::Point> min_square_points;
+    for (const auto& point : min_square) {
+        min_square_points.push_back(cv::Point(point));
+    }
+    cv::polylines(result_image, min_square_points, true, cv::Scalar(0, 0, 255), 3);
+
+    // 在最小正方形旁边显示"最小"字样
+    cv::Point text_pos = min_square_points[0] - cv::Point(10, 10);
+    cv::putText(result_image, "最小", text_pos, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 255), 2);
+}
 
-        // 在最小正方形旁边显示"最小"字样
-        cv::Point text_pos = min_square_points[0] - cv::Point(10, 10);
-        cv::putText(result_image, "最小", text_pos, cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 0, 255), 2);
+void shibie_Square_min(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square) {
+    shibie_Square_min(image, result_image, min_square, SquareDetectOptions());
+}
+
+void shibie_Square_min(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square,
+                       const SquareDetectOptions& options) {
+    // 检测并处理重叠正方形，保留全部候选用于绘制
+    std::vector<std::vector<cv::Point2f>> squares;
+    std::vector<std::vector<cv::Point2f>> non_overlapping_squares;
+    std::vector<double> areas;
+    detectSquares(image, non_overlapping_squares, options, &areas, &squares);
+
+    // 找出最小的正方形
+    findMinSquare(non_overlapping_squares, min_square, &areas);
+
+    drawSquareResult(result_image, squares, min_square);
+}
+
+void detectSquares(const cv::Mat& image, std::vector<std::vector<cv::Point2f>>& squares,
+                   const SquareDetectOptions& options, std::vector<double>* areas,
+                   std::vector<std::vector<cv::Point2f>>* candidates) {
+    // 创建灰度图像，输入已是灰度时直接使用
+    cv::Mat gray;
+    if (image.channels() == 1) {
+        gray = image;
+    } else {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    }
+
+    // 存储所有检测到的正方形，在金字塔层上粗检测
+    std::vector<std::vector<cv::Point2f>> found;
+    int scale = findSquareCandidatesPyramid(gray, found, options);
+
+    // 回到原图精化顶点
+    if (options.refine_corners) {
+        refineSquareCorners(gray, found, scale);
+    }
+
+    // 处理重叠正方形
+    squares.clear();
+    if (areas) {
+        areas->clear();
+    }
+    filterOverlappingSquares(found, squares, areas);
+    if (candidates) {
+        candidates->swap(found);
     }
-}
\ No newline at end of file
+}
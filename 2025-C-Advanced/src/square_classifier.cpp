@@ -0,0 +1,152 @@
+#include "square_classifier.h"
+#include "square_net.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+
+static_assert(SquareClassifier::kCropSize == SquareNet::kInputSize, "裁剪图边长必须等于 SquareNet 的输入尺寸");
+
+SquareClassifier::SquareClassifier(const SquareDetectOptions& options, size_t threads)
+    : options_(options), net_(new SquareNet(threads)), crop_count_(0) {
+    // 构造函数初始化
+}
+
+SquareClassifier::~SquareClassifier() {
+    // 析构函数，SquareNet 在此处为完整类型
+}
+
+bool SquareClassifier::loadWeights(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!net_->loadWeights(path)) {
+        std::cerr << "无法加载数字识别权重: " << path << std::endl;
+        return false;
+    }
+    std::cout << "数字识别权重已加载: " << path << " (" << net_->kernelName()
+              << (net_->isQuantized() ? ", int8" : "") << (net_->isMapped() ? ", mmap" : "") << ")" << std::endl;
+    return true;
+}
+
+bool SquareClassifier::isLoaded() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return net_->isLoaded();
+}
+
+void SquareClassifier::process(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square,
+                               std::vector<SquareDigit>& digits) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 检测与 shibie_Square_min 相同，但保留所有不重叠的正方形
+    detectSquares(image, squares_, options_, &areas_, &candidates_);
+    findMinSquare(squares_, min_square, &areas_);
+
+    // 矫正并分类，结果与几何信息配对输出
+    classifyLocked(image, squares_, digits);
+
+    drawSquareResult(result_image, candidates_, min_square);
+    drawSquareDigits(result_image, digits);
+}
+
+bool SquareClassifier::classify(const cv::Mat& image, const std::vector<std::vector<cv::Point2f>>& squares,
+                                std::vector<SquareDigit>& digits) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return classifyLocked(image, squares, digits);
+}
+
+bool SquareClassifier::classifyLocked(const cv::Mat& image, const std::vector<std::vector<cv::Point2f>>& squares,
+                                      std::vector<SquareDigit>& digits) {
+    digits.clear();
+    crop_count_ = 0;
+
+    // 整理几何信息，顶点统一为左上、右上、右下、左下
+    for (size_t i = 0; i < squares.size(); ++i) {
+        if (squares[i].size() != 4) {
+            continue;
+        }
+        SquareDigit digit;
+        digit.corners = squares[i];
+        orderSquareCorners(digit.corners);
+        digit.center = (digit.corners[0] + digit.corners[1] + digit.corners[2] + digit.corners[3]) * 0.25;
+        digit.edge_length = squareEdgeLength(digit.corners);
+        digits.push_back(digit);
+    }
+    if (digits.empty()) {
+        return true;
+    }
+    if (!net_->isLoaded() || image.empty()) {
+        return false;
+    }
+
+    // 直接从原图透视变换到 128x128，缓冲区尺寸和类型不变时 warpPerspective 不重新分配
+    const float last = static_cast<float>(kCropSize - 1);
+    const cv::Point2f target[4] = {cv::Point2f(0, 0), cv::Point2f(last, 0), cv::Point2f(last, last),
+                                   cv::Point2f(0, last)};
+    if (crops_.size() < digits.size()) {
+        crops_.resize(digits.size());
+    }
+    for (size_t i = 0; i < digits.size(); ++i) {
+        cv::Mat transform = cv::getPerspectiveTransform(digits[i].corners.data(), target);
+        cv::warpPerspective(image, crops_[i], transform, cv::Size(kCropSize, kCropSize), cv::INTER_LINEAR,
+                            cv::BORDER_REPLICATE);
+    }
+    crop_count_ = digits.size();
+
+    // 一帧的全部裁剪图作为一个批次，预处理和推理在 SquareNet 的线程池上并行
+    batch_.assign(crops_.begin(), crops_.begin() + crop_count_);
+    if (!net_->classify(batch_, results_)) {
+        return false;
+    }
+    for (size_t i = 0; i < digits.size(); ++i) {
+        digits[i].digit = results_[i].classId;
+        digits[i].confidence = results_[i].confidence;
+    }
+    return true;
+}
+
+std::vector<cv::Mat> SquareClassifier::lastCrops() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<cv::Mat>(crops_.begin(), crops_.begin() + crop_count_);
+}
+
+const char* SquareClassifier::kernelName() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return net_->isLoaded() ? net_->kernelName() : "";
+}
+
+void orderSquareCorners(std::vector<cv::Point2f>& square) {
+    if (square.size() < 4) {
+        return;
+    }
+    square.resize(4);
+
+    // 按绕中心点的角度排序（图像坐标系下即顺时针），再旋转到左上角开头
+    cv::Point2f center = (square[0] + square[1] + square[2] + square[3]) * 0.25;
+    std::sort(square.begin(), square.end(), [&center](const cv::Point2f& a, const cv::Point2f& b) {
+        return std::atan2(a.y - center.y, a.x - center.x) < std::atan2(b.y - center.y, b.x - center.x);
+    });
+    size_t top_left = 0;
+    for (size_t i = 1; i < 4; ++i) {
+        if (square[i].x + square[i].y < square[top_left].x + square[top_left].y) {
+            top_left = i;
+        }
+    }
+    std::rotate(square.begin(), square.begin() + top_left, square.end());
+}
+
+void drawSquareDigits(cv::Mat& result_image, const std::vector<SquareDigit>& digits) {
+    for (size_t i = 0; i < digits.size(); ++i) {
+        if (digits[i].digit < 0) {
+            continue;
+        }
+
+        // 在正方形中心标注数字，下方标注置信度
+        char text[32];
+        snprintf(text, sizeof(text), "%d", digits[i].digit);
+        cv::Point center(digits[i].center);
+        cv::putText(result_image, text, center + cv::Point(-10, 10), cv::FONT_HERSHEY_SIMPLEX, 1.0,
+                    cv::Scalar(255, 0, 0), 2);
+        snprintf(text, sizeof(text), "%.2f", digits[i].confidence);
+        cv::putText(result_image, text, center + cv::Point(-20, 30), cv::FONT_HERSHEY_SIMPLEX, 0.5,
+                    cv::Scalar(255, 0, 0), 1);
+    }
+}
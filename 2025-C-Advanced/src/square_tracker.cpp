@@ -0,0 +1,183 @@
+#include "square_tracker.h"
+#include "shibie_Square_min.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 速度平滑系数：新观测的权重
+const float kVelocityGain = 0.5f;
+
+// 计算四边形中心点
+cv::Point2f centroidOf(const std::vector<cv::Point2f>& corners) {
+    cv::Point2f sum(0, 0);
+    for (size_t i = 0; i < corners.size(); ++i) {
+        sum += corners[i];
+    }
+    return sum * (1.0 / corners.size());
+}
+
+// 转换为灰度图像，输入已是灰度时直接引用
+void toGray(const cv::Mat& image, cv::Mat& gray) {
+    if (image.channels() == 1) {
+        gray = image;
+    } else {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    }
+}
+
+} // namespace
+
+SquareTracker::SquareTracker(int full_detect_interval, double roi_padding)
+    : full_detect_interval_(full_detect_interval > 0 ? full_detect_interval : 1),
+      roi_padding_(roi_padding),
+      frames_since_full_(0),
+      full_detections_(0),
+      roi_detections_(0) {
+    // 构造函数初始化
+}
+
+void SquareTracker::process(const cv::Mat& image, cv::Mat& result_image, std::vector<cv::Point2f>& min_square) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 所有检测到的正方形（用于绘制）
+    std::vector<std::vector<cv::Point2f>> squares;
+
+    // 有跟踪目标且未到全图检测周期时，只在各目标的 ROI 内检测
+    // 更新作用在副本上，全部目标都找到后才替换：有目标丢失时，全图检测仍以上一帧的位置计算速度，
+    // 不会与已更新到本帧的目标关联而得到接近零的速度
+    bool need_full = tracks_.empty() || frames_since_full_ >= full_detect_interval_;
+    if (!need_full) {
+        std::vector<Track> updated(tracks_);
+        for (size_t i = 0; i < updated.size(); ++i) {
+            if (!updateTrack(image, updated[i], squares)) {
+                // 目标丢失，本帧退回全图检测
+                need_full = true;
+                break;
+            }
+        }
+        if (!need_full) {
+            tracks_.swap(updated);
+        }
+        ++frames_since_full_;
+    }
+
+    if (need_full) {
+        squares.clear();
+        detectFull(image, squares);
+    }
+
+    // 在跟踪目标中找出最小的正方形
+    std::vector<std::vector<cv::Point2f>> targets;
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        targets.push_back(tracks_[i].corners);
+    }
+    findMinSquare(targets, min_square);
+
+    drawSquareResult(result_image, squares, min_square);
+}
+
+void SquareTracker::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tracks_.clear();
+    frames_since_full_ = 0;
+}
+
+size_t SquareTracker::fullDetections() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return full_detections_;
+}
+
+size_t SquareTracker::roiDetections() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return roi_detections_;
+}
+
+void SquareTracker::detectFull(const cv::Mat& image, std::vector<std::vector<cv::Point2f>>& squares) {
+    cv::Mat gray;
+    toGray(image, gray);
+    findSquareCandidates(gray, squares);
+
+    std::vector<std::vector<cv::Point2f>> targets;
+    std::vector<double> areas;
+    filterOverlappingSquares(squares, targets, &areas);
+
+    // 重建跟踪目标，与上一帧最近的目标关联以继承速度
+    std::vector<Track> new_tracks;
+    for (size_t i = 0; i < targets.size(); ++i) {
+        Track track;
+        track.corners = targets[i];
+        track.velocity = cv::Point2f(0, 0);
+
+        cv::Point2f center = centroidOf(targets[i]);
+        double max_dist = std::sqrt(areas[i]);
+        double best_dist = max_dist;
+        for (size_t j = 0; j < tracks_.size(); ++j) {
+            cv::Point2f motion = center - centroidOf(tracks_[j].corners);
+            double dist = cv::norm(motion);
+            if (dist < best_dist) {
+                best_dist = dist;
+                track.velocity = motion;
+            }
+        }
+        new_tracks.push_back(track);
+    }
+
+    tracks_.swap(new_tracks);
+    frames_since_full_ = 0;
+    ++full_detections_;
+}
+
+bool SquareTracker::updateTrack(const cv::Mat& image, Track& track, std::vector<std::vector<cv::Point2f>>& squares) {
+    // 按匀速模型预测本帧位置
+    std::vector<cv::Point2f> predicted(track.corners.size());
+    for (size_t i = 0; i < track.corners.size(); ++i) {
+        predicted[i] = track.corners[i] + track.velocity;
+    }
+    cv::Point2f predicted_center = centroidOf(predicted);
+
+    // 预测位置外扩得到 ROI，速度越大外扩越多
+    cv::Rect box = cv::boundingRect(predicted);
+    double size = std::max(box.width, box.height);
+    double speed = cv::norm(track.velocity);
+    int pad = static_cast<int>(roi_padding_ * size + speed + 4);
+    cv::Rect roi(box.x - pad, box.y - pad, box.width + 2 * pad, box.height + 2 * pad);
+    roi &= cv::Rect(0, 0, image.cols, image.rows);
+    if (roi.width < 8 || roi.height < 8) {
+        return false;
+    }
+
+    // 只对 ROI 做灰度化和检测
+    cv::Mat gray;
+    toGray(image(roi), gray);
+    std::vector<std::vector<cv::Point2f>> candidates;
+    findSquareCandidates(gray, candidates, roi.tl());
+    ++roi_detections_;
+
+    // 选出与预测位置最近、面积相近的候选
+    double track_area = cv::contourArea(track.corners);
+    double max_dist = 0.5 * size + speed;
+    int best = -1;
+    double best_dist = max_dist;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        double area = cv::contourArea(candidates[i]);
+        if (area < 0.5 * track_area || area > 2.0 * track_area) {
+            continue;
+        }
+        double dist = cv::norm(centroidOf(candidates[i]) - predicted_center);
+        if (dist <= best_dist) {
+            best_dist = dist;
+            best = static_cast<int>(i);
+        }
+    }
+    squares.insert(squares.end(), candidates.begin(), candidates.end());
+    if (best < 0) {
+        return false;
+    }
+
+    // 更新位置和平滑后的速度
+    cv::Point2f motion = centroidOf(candidates[best]) - centroidOf(track.corners);
+    track.velocity = track.velocity * (1.0f - kVelocityGain) + motion * kVelocityGain;
+    track.corners = candidates[best];
+    return true;
+}
@@ -0,0 +1,413 @@
+#include "thread_deal.h"
+#include <iostream>
+#include <exception>
+#include <chrono>
+#include <cstdint>
+
+namespace {
+
+// 当前线程所属的线程池及其工作线程编号（非工作线程为 nullptr）
+thread_local const ThreadPool* tls_pool = nullptr;
+thread_local size_t tls_index = 0;
+
+// 每个线程本地空闲链表的最大节点数，超出部分归还到全局空闲链表
+const size_t kLocalCacheLimit = 256;
+
+// 每次从全局空闲链表批量取出的节点数
+const size_t kRefillBatch = 64;
+
+// 工作线程进入休眠前的自旋次数
+const int kSpinRounds = 64;
+
+// 每个工作线程任务队列的容量（必须是2的幂）
+const int64_t kDequeCapacity = 1024;
+
+} // namespace
+
+/**
+ * Chase-Lev 无锁工作窃取双端队列
+ * 只有所属线程可以从底部 push/pop，其他线程从顶部 steal
+ * 容量固定，push 失败时由调用者改为放入注入队列
+ */
+class ThreadPool::WorkStealingDeque {
+public:
+    WorkStealingDeque() : top_(0), bottom_(0), buffer_(new std::atomic<TaskNode*>[kDequeCapacity]) {
+        for (int64_t i = 0; i < kDequeCapacity; ++i) {
+            buffer_[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    // 所属线程压入任务，队列满时返回false
+    bool push(TaskNode* node) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= kDequeCapacity) {
+            return false;
+        }
+        buffer_[b & (kDequeCapacity - 1)].store(node, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // 所属线程从底部取出任务（后进先出，缓存友好）
+    TaskNode* pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // 队列为空
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        TaskNode* node = buffer_[b & (kDequeCapacity - 1)].load(std::memory_order_relaxed);
+        if (t == b) {
+            // 只剩最后一个任务，与窃取者竞争
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                node = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return node;
+    }
+
+    // 其他线程从顶部窃取任务（先进先出）
+    TaskNode* steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+
+        TaskNode* node = buffer_[t & (kDequeCapacity - 1)].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            // 被其他线程抢先
+            return nullptr;
+        }
+        return node;
+    }
+
+private:
+    std::atomic<int64_t> top_; // 窃取端下标
+    std::atomic<int64_t> bottom_; // 所属线程端下标
+    std::unique_ptr<std::atomic<TaskNode*>[]> buffer_; // 环形缓冲区
+};
+
+/**
+ * 线程本地空闲链表
+ * 节点用完后留在执行它的线程中复用；本地链表过长或为空时与全局空闲链表批量交换，
+ * 线程退出时把节点归还到全局空闲链表
+ */
+struct NodeCache {
+    typedef ThreadPool::TaskNode TaskNode;
+
+    TaskNode* head; // 本地链表头
+    size_t count; // 本地链表长度
+
+    static std::mutex global_mutex; // 全局空闲链表互斥锁
+    static TaskNode* global_head; // 全局空闲链表头
+
+    NodeCache() : head(nullptr), count(0) {}
+
+    ~NodeCache() {
+        if (!head) {
+            return;
+        }
+        TaskNode* tail = head;
+        while (tail->next) {
+            tail = tail->next;
+        }
+        std::lock_guard<std::mutex> lock(global_mutex);
+        tail->next = global_head;
+        global_head = head;
+        head = nullptr;
+        count = 0;
+    }
+};
+
+std::mutex NodeCache::global_mutex;
+NodeCache::TaskNode* NodeCache::global_head = nullptr;
+
+namespace {
+
+thread_local NodeCache tls_node_cache;
+
+} // namespace
+
+ThreadPool::TaskNode* ThreadPool::acquireNode() {
+    NodeCache& cache = tls_node_cache;
+    if (!cache.head) {
+        // 从全局空闲链表批量补充
+        std::lock_guard<std::mutex> lock(NodeCache::global_mutex);
+        while (NodeCache::global_head && cache.count < kRefillBatch) {
+            TaskNode* node = NodeCache::global_head;
+            NodeCache::global_head = node->next;
+            node->next = cache.head;
+            cache.head = node;
+            ++cache.count;
+        }
+    }
+
+    if (cache.head) {
+        TaskNode* node = cache.head;
+        cache.head = node->next;
+        --cache.count;
+        node->next = nullptr;
+        return node;
+    }
+    return new TaskNode();
+}
+
+void ThreadPool::releaseNode(TaskNode* node) {
+    NodeCache& cache = tls_node_cache;
+    node->next = cache.head;
+    cache.head = node;
+    ++cache.count;
+
+    if (cache.count > kLocalCacheLimit) {
+        // 本地链表过长（节点在线程间单向流动），归还一半到全局空闲链表
+        TaskNode* first = cache.head;
+        TaskNode* last = first;
+        for (size_t i = 1; i < kLocalCacheLimit / 2; ++i) {
+            last = last->next;
+        }
+        cache.head = last->next;
+        cache.count -= kLocalCacheLimit / 2;
+
+        std::lock_guard<std::mutex> lock(NodeCache::global_mutex);
+        last->next = NodeCache::global_head;
+        NodeCache::global_head = first;
+    }
+}
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : injected_head_(nullptr),
+      injected_tail_(nullptr),
+      injected_count_(0),
+      sleepers_(0),
+      pending_(0),
+      stop_(false),
+      active_tasks_(0) {
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+
+    for (size_t i = 0; i < num_threads; ++i) {
+        deques_.push_back(std::unique_ptr<WorkStealingDeque>(new WorkStealingDeque()));
+    }
+    for (size_t i = 0; i < num_threads; ++i) {
+        workers_.push_back(std::thread(&ThreadPool::workerThread, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    waitForCompletion();
+
+    stop_ = true;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        condition_.notify_all();
+    }
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        if (workers_[i].joinable()) {
+            workers_[i].join();
+        }
+    }
+}
+
+void ThreadPool::waitForCompletion() {
+    while (active_tasks_.load() > 0) {
+        if (runPendingTask()) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(active_tasks_mutex_);
+        completion_.wait_for(lock, std::chrono::milliseconds(1), [this]() { return active_tasks_.load() == 0; });
+    }
+}
+
+size_t ThreadPool::size() const {
+    return workers_.size();
+}
+
+size_t ThreadPool::pendingTasks() const {
+    return pending_.load(std::memory_order_relaxed);
+}
+
+void ThreadPool::pushBatch(TaskNode* head, TaskNode* tail, size_t count) {
+    if (!head || count == 0) {
+        return;
+    }
+    tail->next = nullptr;
+
+    // 先计数再入队，保证任务被取走时计数已经包含它
+    active_tasks_.fetch_add(count);
+    pending_.fetch_add(count);
+
+    if (tls_pool == this) {
+        // 工作线程：压入自己的队列，队列满时剩余部分进入注入队列
+        WorkStealingDeque& deque = *deques_[tls_index];
+        while (head) {
+            TaskNode* next = head->next;
+            head->next = nullptr;
+            if (!deque.push(head)) {
+                head->next = next;
+                break;
+            }
+            head = next;
+        }
+    }
+
+    if (head) {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        size_t remaining = 0;
+        for (TaskNode* node = head; node; node = node->next) {
+            ++remaining;
+        }
+        if (injected_tail_) {
+            injected_tail_->next = head;
+        } else {
+            injected_head_ = head;
+        }
+        injected_tail_ = tail;
+        injected_count_ += remaining;
+    }
+
+    // 唤醒休眠的工作线程
+    if (sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        if (count > 1) {
+            condition_.notify_all();
+        } else {
+            condition_.notify_one();
+        }
+    }
+}
+
+ThreadPool::TaskNode* ThreadPool::findTask(size_t self) {
+    size_t num_deques = deques_.size();
+    bool is_worker = self < num_deques;
+
+    // 1. 自己的队列
+    if (is_worker) {
+        TaskNode* node = deques_[self]->pop();
+        if (node) {
+            pending_.fetch_sub(1);
+            return node;
+        }
+    }
+
+    // 2. 注入队列：工作线程一次取走一批，多余的放入自己的队列供他人窃取
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex_);
+        if (injected_head_) {
+            TaskNode* node = injected_head_;
+            injected_head_ = node->next;
+            --injected_count_;
+
+            if (is_worker) {
+                size_t extra = std::min(injected_count_ / num_deques, static_cast<size_t>(32));
+                while (extra > 0 && injected_head_) {
+                    TaskNode* moved = injected_head_;
+                    if (!deques_[self]->push(moved)) {
+                        break;
+                    }
+                    injected_head_ = moved->next;
+                    moved->next = nullptr;
+                    --injected_count_;
+                    --extra;
+                }
+            }
+
+            if (!injected_head_) {
+                injected_tail_ = nullptr;
+            }
+            lock.unlock();
+
+            node->next = nullptr;
+            pending_.fetch_sub(1);
+            return node;
+        }
+    }
+
+    // 3. 从其他线程的队列窃取
+    size_t start = is_worker ? self + 1 : 0;
+    for (size_t i = 0; i < num_deques; ++i) {
+        size_t victim = (start + i) % num_deques;
+        if (victim == self) {
+            continue;
+        }
+        TaskNode* node = deques_[victim]->steal();
+        if (node) {
+            pending_.fetch_sub(1);
+            return node;
+        }
+    }
+    return nullptr;
+}
+
+bool ThreadPool::runPendingTask() {
+    size_t self = (tls_pool == this) ? tls_index : deques_.size();
+    TaskNode* node = findTask(self);
+    if (!node) {
+        return false;
+    }
+    runNode(node);
+    return true;
+}
+
+void ThreadPool::runNode(TaskNode* node) {
+    // parallelFor 的块自行捕获异常并交给调用线程重新抛出，这里只会遇到 enqueue 提交的裸任务
+    try {
+        node->task();
+    } catch (const std::exception& e) {
+        std::cerr << "线程池任务异常: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "线程池任务异常: 未知异常" << std::endl;
+    }
+    node->task.reset();
+    releaseNode(node);
+
+    if (active_tasks_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(active_tasks_mutex_);
+        completion_.notify_all();
+    }
+}
+
+void ThreadPool::workerThread(size_t index) {
+    tls_pool = this;
+    tls_index = index;
+
+    while (true) {
+        TaskNode* node = findTask(index);
+        if (node) {
+            runNode(node);
+            continue;
+        }
+
+        // 短暂自旋，避免频繁休眠唤醒
+        for (int i = 0; i < kSpinRounds && !node; ++i) {
+            std::this_thread::yield();
+            node = findTask(index);
+        }
+        if (node) {
+            runNode(node);
+            continue;
+        }
+
+        if (stop_) {
+            break;
+        }
+
+        // 没有任务，休眠等待
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers_.fetch_add(1);
+        condition_.wait(lock, [this]() { return stop_.load() || pending_.load() > 0; });
+        sleepers_.fetch_sub(1);
+    }
+
+    tls_pool = nullptr;
+}
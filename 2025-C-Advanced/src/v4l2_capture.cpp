@@ -0,0 +1,278 @@
+#include "v4l2_capture.h"
+#include <iostream>
+#include <vector>
+#include <mutex>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <linux/videodev2.h>
+
+namespace {
+
+// 被信号打断时重试的 ioctl
+int xioctl(int fd, unsigned long request, void* arg) {
+    int ret;
+    do {
+        ret = ioctl(fd, request, arg);
+    } while (ret < 0 && errno == EINTR);
+    return ret;
+}
+
+uint32_t toFourcc(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::NV12: return V4L2_PIX_FMT_NV12;
+        case PixelFormat::GRAY: return V4L2_PIX_FMT_GREY;
+        case PixelFormat::YUYV:
+        default:                return V4L2_PIX_FMT_YUYV;
+    }
+}
+
+} // namespace
+
+/**
+ * 流状态
+ * 由采集后端和所有未归还的帧租约共享，最后一个持有者释放时才停止采集并解除映射，
+ * 因此即使后端先于帧被销毁，帧引用的内存也仍然有效
+ */
+struct V4l2Capture::Stream {
+    struct Buffer {
+        void* start; // 映射地址
+        size_t length; // 映射长度
+    };
+
+    // 帧租约的释放器：最后一个引用释放时把缓冲区重新入队
+    struct Lease {
+        std::shared_ptr<Stream> stream;
+        unsigned index;
+
+        void operator()(void*) const {
+            stream->queue(index);
+        }
+    };
+
+    int fd; // 设备文件描述符
+    std::vector<Buffer> buffers; // 驱动缓冲区
+    size_t bytes_per_line; // 每行字节数（Y平面）
+    bool streaming; // 是否已开始采集
+    std::mutex mutex; // 保护入队操作
+
+    Stream() : fd(-1), bytes_per_line(0), streaming(false) {}
+
+    ~Stream() {
+        if (streaming) {
+            enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+            xioctl(fd, VIDIOC_STREAMOFF, &type);
+        }
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            munmap(buffers[i].start, buffers[i].length);
+        }
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    // 把缓冲区重新交给驱动
+    bool queue(unsigned index) {
+        struct v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = index;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (xioctl(fd, VIDIOC_QBUF, &buf) < 0) {
+            std::cerr << "V4L2 缓冲区入队失败: " << strerror(errno) << std::endl;
+            return false;
+        }
+        return true;
+    }
+};
+
+V4l2Capture::V4l2Capture(const std::string& device, int width, int height, PixelFormat format, int buffer_count)
+    : device_(device),
+      width_(width),
+      height_(height),
+      format_(format),
+      buffer_count_(buffer_count > 1 ? buffer_count : 2),
+      timeout_ms_(1000) {
+    // 构造函数初始化
+}
+
+V4l2Capture::~V4l2Capture() {
+    // 析构函数关闭设备
+    close();
+}
+
+bool V4l2Capture::open() {
+    close();
+
+    std::shared_ptr<Stream> stream(new Stream());
+    stream->fd = ::open(device_.c_str(), O_RDWR | O_NONBLOCK);
+    if (stream->fd < 0) {
+        std::cerr << "无法打开设备 " << device_ << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // 检查设备能力
+    struct v4l2_capability cap;
+    memset(&cap, 0, sizeof(cap));
+    if (xioctl(stream->fd, VIDIOC_QUERYCAP, &cap) < 0) {
+        std::cerr << "不是 V4L2 设备: " << device_ << std::endl;
+        return false;
+    }
+    if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) || !(cap.capabilities & V4L2_CAP_STREAMING)) {
+        std::cerr << "设备不支持视频流采集: " << device_ << std::endl;
+        return false;
+    }
+
+    // 设置分辨率和像素格式
+    struct v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = width_;
+    fmt.fmt.pix.height = height_;
+    fmt.fmt.pix.pixelformat = toFourcc(format_);
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (xioctl(stream->fd, VIDIOC_S_FMT, &fmt) < 0) {
+        std::cerr << "设置采集格式失败: " << strerror(errno) << std::endl;
+        return false;
+    }
+    if (fmt.fmt.pix.pixelformat != toFourcc(format_)) {
+        std::cerr << "设备不支持请求的像素格式" << std::endl;
+        return false;
+    }
+    // 驱动可能调整分辨率，以协商结果为准
+    width_ = fmt.fmt.pix.width;
+    height_ = fmt.fmt.pix.height;
+    stream->bytes_per_line = fmt.fmt.pix.bytesperline;
+    if (stream->bytes_per_line == 0) {
+        stream->bytes_per_line = format_ == PixelFormat::YUYV ? width_ * 2 : width_;
+    }
+
+    // 申请 mmap 缓冲区
+    struct v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = buffer_count_;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(stream->fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+        std::cerr << "申请 V4L2 缓冲区失败" << std::endl;
+        return false;
+    }
+
+    for (unsigned i = 0; i < req.count; ++i) {
+        struct v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (xioctl(stream->fd, VIDIOC_QUERYBUF, &buf) < 0) {
+            std::cerr << "查询 V4L2 缓冲区失败: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        Stream::Buffer mapped;
+        mapped.length = buf.length;
+        mapped.start = mmap(NULL, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, stream->fd, buf.m.offset);
+        if (mapped.start == MAP_FAILED) {
+            std::cerr << "映射 V4L2 缓冲区失败: " << strerror(errno) << std::endl;
+            return false;
+        }
+        stream->buffers.push_back(mapped);
+    }
+
+    // 所有缓冲区入队并开始采集
+    for (unsigned i = 0; i < stream->buffers.size(); ++i) {
+        if (!stream->queue(i)) {
+            return false;
+        }
+    }
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(stream->fd, VIDIOC_STREAMON, &type) < 0) {
+        std::cerr << "启动 V4L2 采集失败: " << strerror(errno) << std::endl;
+        return false;
+    }
+    stream->streaming = true;
+
+    stream_ = stream;
+    return true;
+}
+
+bool V4l2Capture::grab(CaptureFrame& frame) {
+    if (!stream_) {
+        return false;
+    }
+
+    // 释放上一帧的租约，使其缓冲区可以重新入队
+    frame.lease.reset();
+    frame.image.release();
+
+    // 等待新帧
+    struct pollfd pfd;
+    pfd.fd = stream_->fd;
+    pfd.events = POLLIN;
+    int ret;
+    do {
+        ret = poll(&pfd, 1, timeout_ms_);
+    } while (ret < 0 && errno == EINTR);
+    if (ret <= 0) {
+        std::cerr << "等待 V4L2 帧超时" << std::endl;
+        return false;
+    }
+
+    // 出队一个已填充的缓冲区
+    struct v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(stream_->fd, VIDIOC_DQBUF, &buf) < 0) {
+        std::cerr << "V4L2 缓冲区出队失败: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // 直接把驱动缓冲区包装为 cv::Mat，不拷贝
+    void* data = stream_->buffers[buf.index].start;
+    size_t stride = stream_->bytes_per_line;
+    switch (format_) {
+        case PixelFormat::YUYV:
+            frame.image = cv::Mat(height_, width_, CV_8UC2, data, stride);
+            break;
+        case PixelFormat::NV12:
+            frame.image = cv::Mat(height_ * 3 / 2, width_, CV_8UC1, data, stride);
+            break;
+        case PixelFormat::GRAY:
+        default:
+            frame.image = cv::Mat(height_, width_, CV_8UC1, data, stride);
+            break;
+    }
+    frame.format = format_;
+    frame.sequence = buf.sequence;
+    frame.timestamp_us = static_cast<int64_t>(buf.timestamp.tv_sec) * 1000000 + buf.timestamp.tv_usec;
+    frame.read_only = true;
+
+    Stream::Lease releaser;
+    releaser.stream = stream_;
+    releaser.index = buf.index;
+    frame.lease = std::shared_ptr<void>(data, releaser);
+    return true;
+}
+
+void V4l2Capture::close() {
+    // 流状态在所有租约归还后才真正释放
+    stream_.reset();
+}
+
+bool V4l2Capture::isOpened() const {
+    return stream_ != nullptr;
+}
+
+int V4l2Capture::width() const {
+    return width_;
+}
+
+int V4l2Capture::height() const {
+    return height_;
+}
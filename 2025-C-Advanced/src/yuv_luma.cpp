@@ -0,0 +1,116 @@
+#include "yuv_luma.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define YUV_LUMA_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define YUV_LUMA_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+typedef void (*LumaRowFunc)(const uint8_t* src, uint8_t* dst, int width);
+
+// 标量实现：Y 位于偶数字节
+void lumaRowScalar(const uint8_t* src, uint8_t* dst, int width) {
+    for (int x = 0; x < width; ++x) {
+        dst[x] = src[x * 2];
+    }
+}
+
+#ifdef YUV_LUMA_X86
+
+// SSE2：每次处理 32 字节输入，输出 16 个亮度值
+__attribute__((target("sse2")))
+void lumaRowSse2(const uint8_t* src, uint8_t* dst, int width) {
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 2 + 16));
+        __m128i y = _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), y);
+    }
+    lumaRowScalar(src + x * 2, dst + x, width - x);
+}
+
+// AVX2：每次处理 64 字节输入，输出 32 个亮度值
+__attribute__((target("avx2")))
+void lumaRowAvx2(const uint8_t* src, uint8_t* dst, int width) {
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 2));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + x * 2 + 32));
+        // packus 按128位通道交错，需要再按64位重排
+        __m256i y = _mm256_packus_epi16(_mm256_and_si256(a, mask), _mm256_and_si256(b, mask));
+        y = _mm256_permute4x64_epi64(y, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), y);
+    }
+    lumaRowSse2(src + x * 2, dst + x, width - x);
+}
+
+#endif
+
+#ifdef YUV_LUMA_NEON
+
+// NEON：vld2 直接按字节解交错，val[0] 即为亮度
+void lumaRowNeon(const uint8_t* src, uint8_t* dst, int width) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16x2_t yuyv = vld2q_u8(src + x * 2);
+        vst1q_u8(dst + x, yuyv.val[0]);
+    }
+    lumaRowScalar(src + x * 2, dst + x, width - x);
+}
+
+#endif
+
+struct LumaKernel {
+    LumaRowFunc row;
+    const char* name;
+};
+
+// 运行时选择当前 CPU 支持的最快实现
+LumaKernel selectKernel() {
+    LumaKernel kernel;
+#if defined(YUV_LUMA_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernel.row = lumaRowAvx2;
+        kernel.name = "avx2";
+        return kernel;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        kernel.row = lumaRowSse2;
+        kernel.name = "sse2";
+        return kernel;
+    }
+#elif defined(YUV_LUMA_NEON)
+    kernel.row = lumaRowNeon;
+    kernel.name = "neon";
+    return kernel;
+#endif
+    kernel.row = lumaRowScalar;
+    kernel.name = "scalar";
+    return kernel;
+}
+
+const LumaKernel& kernel() {
+    static const LumaKernel selected = selectKernel();
+    return selected;
+}
+
+} // namespace
+
+void extractLumaYuyv(const uint8_t* src, size_t src_stride, uint8_t* dst, size_t dst_stride, int width, int height) {
+    LumaRowFunc row = kernel().row;
+    for (int y = 0; y < height; ++y) {
+        row(src + y * src_stride, dst + y * dst_stride, width);
+    }
+}
+
+const char* lumaKernelName() {
+    return kernel().name;
+}
@@ -7,10 +7,22 @@ mkdir -p ../build
 
 # 编译C++代码
 echo "开始编译..."
-g++ -std=c++11 ../src/main.cpp ../src/python_wrapper.cpp -o ../build/number_square_recognizer \
+g++ -std=c++11 -O2 -pthread ../src/main.cpp ../src/python_wrapper.cpp ../src/recognition_service.cpp ../src/recognition_cache.cpp \
+    ../src/square_net.cpp ../src/gemm.cpp ../src/worker_pool.cpp ../src/weights_file.cpp -o ../build/number_square_recognizer \
     -I/usr/include/python3.8 \
     -lpython3.8 \
-    -I../src
+    -I../src \
+    $(pkg-config --cflags --libs opencv4) && \
+g++ -std=c++11 -O2 -pthread ../src/square_net_check.cpp \
+    ../src/square_net.cpp ../src/gemm.cpp ../src/worker_pool.cpp ../src/weights_file.cpp -o ../build/square_net_check \
+    -I../src \
+    $(pkg-config --cflags --libs opencv4) && \
+g++ -std=c++11 -O2 -pthread ../src/recognition_service_check.cpp \
+    ../src/recognition_service.cpp ../src/python_wrapper.cpp -o ../build/recognition_service_check \
+    -I/usr/include/python3.8 \
+    -lpython3.8 \
+    -I../src \
+    $(pkg-config --cflags --libs opencv4)
 
 # 检查编译是否成功
 if [ $? -eq 0 ]; then
@@ -0,0 +1,347 @@
+#include "gemm.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GEMM_X86 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define GEMM_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+const int kRowBlock = 32; // 并行切分的行块大小
+const int kColBlock = 64; // 并行切分的列块大小，B 的 K x 64 子块可以留在 L2 中
+
+// 一个并行块：C 的 [m0, m1) x [n0, n1)
+struct GemmArgs {
+    int K;
+    const float* A;
+    int lda;
+    const float* B;
+    int ldb;
+    float* C;
+    int ldc;
+    const float* bias;
+    bool relu;
+};
+
+typedef void (*GemmBlockFunc)(const GemmArgs& args, int m0, int m1, int n0, int n1);
+typedef float (*DotFunc)(const float* a, const float* b, int n);
+typedef int32_t (*DotInt8Func)(const uint8_t* a, const int8_t* b, int n);
+
+// 标量实现：逐行做 saxpy，内层循环连续访问，便于编译器自动向量化
+void gemmBlockScalar(const GemmArgs& args, int m0, int m1, int n0, int n1) {
+    for (int i = m0; i < m1; ++i) {
+        float* c = args.C + static_cast<size_t>(i) * args.ldc;
+        float init = args.bias ? args.bias[i] : 0.0f;
+        for (int j = n0; j < n1; ++j) {
+            c[j] = init;
+        }
+        const float* a = args.A + static_cast<size_t>(i) * args.lda;
+        for (int k = 0; k < args.K; ++k) {
+            float aik = a[k];
+            const float* b = args.B + static_cast<size_t>(k) * args.ldb;
+            for (int j = n0; j < n1; ++j) {
+                c[j] += aik * b[j];
+            }
+        }
+        if (args.relu) {
+            for (int j = n0; j < n1; ++j) {
+                c[j] = std::max(c[j], 0.0f);
+            }
+        }
+    }
+}
+
+// 标量点积：8 路独立累加，打破加法依赖链
+float dotScalar(const float* a, const float* b, int n) {
+    float acc[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (int j = 0; j < 8; ++j) {
+            acc[j] += a[i + j] * b[i + j];
+        }
+    }
+    float sum = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// 标量 INT8 点积：int32 累加
+int32_t dotInt8Scalar(const uint8_t* a, const int8_t* b, int n) {
+    int32_t acc[4] = {0, 0, 0, 0};
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (int j = 0; j < 4; ++j) {
+            acc[j] += a[i + j] * b[i + j];
+        }
+    }
+    int32_t sum = acc[0] + acc[1] + acc[2] + acc[3];
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#ifdef GEMM_X86
+
+// 8 个 float 水平求和
+__attribute__((target("avx2,fma")))
+float horizontalSum(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+    lo = _mm_add_ss(lo, _mm_movehdup_ps(lo));
+    return _mm_cvtss_f32(lo);
+}
+
+// AVX2+FMA：4 行 x 16 列的寄存器分块，8 个累加器常驻寄存器，
+// 每个 k 只加载两次 B、广播四次 A；不足 4x16 的边缘交给标量实现
+__attribute__((target("avx2,fma")))
+void gemmBlockAvx2(const GemmArgs& args, int m0, int m1, int n0, int n1) {
+    int m_full = m0 + (m1 - m0) / 4 * 4;
+    int n_full = n0 + (n1 - n0) / 16 * 16;
+    const __m256 zero = _mm256_setzero_ps();
+
+    for (int i = m0; i < m_full; i += 4) {
+        const float* a0 = args.A + static_cast<size_t>(i) * args.lda;
+        const float* a1 = a0 + args.lda;
+        const float* a2 = a1 + args.lda;
+        const float* a3 = a2 + args.lda;
+        for (int j = n0; j < n_full; j += 16) {
+            __m256 c00, c01, c10, c11, c20, c21, c30, c31;
+            if (args.bias) {
+                c00 = c01 = _mm256_set1_ps(args.bias[i]);
+                c10 = c11 = _mm256_set1_ps(args.bias[i + 1]);
+                c20 = c21 = _mm256_set1_ps(args.bias[i + 2]);
+                c30 = c31 = _mm256_set1_ps(args.bias[i + 3]);
+            } else {
+                c00 = c01 = c10 = c11 = c20 = c21 = c30 = c31 = zero;
+            }
+
+            const float* b = args.B + j;
+            for (int k = 0; k < args.K; ++k, b += args.ldb) {
+                __m256 b0 = _mm256_loadu_ps(b);
+                __m256 b1 = _mm256_loadu_ps(b + 8);
+                __m256 a = _mm256_broadcast_ss(a0 + k);
+                c00 = _mm256_fmadd_ps(a, b0, c00);
+                c01 = _mm256_fmadd_ps(a, b1, c01);
+                a = _mm256_broadcast_ss(a1 + k);
+                c10 = _mm256_fmadd_ps(a, b0, c10);
+                c11 = _mm256_fmadd_ps(a, b1, c11);
+                a = _mm256_broadcast_ss(a2 + k);
+                c20 = _mm256_fmadd_ps(a, b0, c20);
+                c21 = _mm256_fmadd_ps(a, b1, c21);
+                a = _mm256_broadcast_ss(a3 + k);
+                c30 = _mm256_fmadd_ps(a, b0, c30);
+                c31 = _mm256_fmadd_ps(a, b1, c31);
+            }
+
+            if (args.relu) {
+                c00 = _mm256_max_ps(c00, zero);
+                c01 = _mm256_max_ps(c01, zero);
+                c10 = _mm256_max_ps(c10, zero);
+                c11 = _mm256_max_ps(c11, zero);
+                c20 = _mm256_max_ps(c20, zero);
+                c21 = _mm256_max_ps(c21, zero);
+                c30 = _mm256_max_ps(c30, zero);
+                c31 = _mm256_max_ps(c31, zero);
+            }
+            float* c = args.C + static_cast<size_t>(i) * args.ldc + j;
+            _mm256_storeu_ps(c, c00);
+            _mm256_storeu_ps(c + 8, c01);
+            c += args.ldc;
+            _mm256_storeu_ps(c, c10);
+            _mm256_storeu_ps(c + 8, c11);
+            c += args.ldc;
+            _mm256_storeu_ps(c, c20);
+            _mm256_storeu_ps(c + 8, c21);
+            c += args.ldc;
+            _mm256_storeu_ps(c, c30);
+            _mm256_storeu_ps(c + 8, c31);
+        }
+    }
+
+    // 右侧不足 16 列、下方不足 4 行的部分
+    if (n_full < n1) {
+        gemmBlockScalar(args, m0, m_full, n_full, n1);
+    }
+    if (m_full < m1) {
+        gemmBlockScalar(args, m_full, m1, n0, n1);
+    }
+}
+
+// AVX2+FMA 点积：4 个累加器，每次迭代 32 个元素
+__attribute__((target("avx2,fma")))
+float dotAvx2(const float* a, const float* b, int n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps();
+    __m256 acc3 = _mm256_setzero_ps();
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+    }
+    float sum = horizontalSum(_mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3)));
+    for (; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+// AVX2 INT8 点积：maddubs 把相邻两对 u8 x s8 乘积加为 int16，
+// a 不超过 127 时 2 x 127 x 127 不会饱和；再用 madd 扩展为 int32 累加，每次迭代 64 个元素
+__attribute__((target("avx2")))
+int32_t dotInt8Avx2(const uint8_t* a, const int8_t* b, int n) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m256i p0 = _mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+                                          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        __m256i p1 = _mm256_maddubs_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32)),
+                                          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32)));
+        acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(p0, ones));
+        acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(p1, ones));
+    }
+    __m256i acc = _mm256_add_epi32(acc0, acc1);
+    __m128i sum4 = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum4 = _mm_add_epi32(sum4, _mm_shuffle_epi32(sum4, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum4 = _mm_add_epi32(sum4, _mm_shuffle_epi32(sum4, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum4) + dotInt8Scalar(a + i, b + i, n - i);
+}
+
+#endif
+
+#ifdef GEMM_NEON
+
+// NEON INT8 点积：vmull 得到 int16 乘积，vpadal 两两相加累加到 int32，每次迭代 16 个元素
+int32_t dotInt8Neon(const uint8_t* a, const int8_t* b, int n) {
+    int32x4_t acc = vdupq_n_s32(0);
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int8x16_t va = vreinterpretq_s8_u8(vld1q_u8(a + i)); // a 不超过 127，可按有符号处理
+        int8x16_t vb = vld1q_s8(b + i);
+        acc = vpadalq_s16(acc, vmull_s8(vget_low_s8(va), vget_low_s8(vb)));
+        acc = vpadalq_s16(acc, vmull_s8(vget_high_s8(va), vget_high_s8(vb)));
+    }
+    int32x2_t sum2 = vadd_s32(vget_low_s32(acc), vget_high_s32(acc));
+    return vget_lane_s32(vpadd_s32(sum2, sum2), 0) + dotInt8Scalar(a + i, b + i, n - i);
+}
+
+#endif
+
+struct GemmKernel {
+    GemmBlockFunc block;
+    DotFunc dot;
+    DotInt8Func dot_int8;
+    const char* name;
+    const char* int8_name;
+};
+
+// 运行时选择当前 CPU 支持的最快实现
+GemmKernel selectKernel() {
+    GemmKernel kernel;
+    kernel.block = gemmBlockScalar;
+    kernel.dot = dotScalar;
+    kernel.dot_int8 = dotInt8Scalar;
+    kernel.name = "scalar";
+    kernel.int8_name = "scalar";
+#if defined(GEMM_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernel.dot_int8 = dotInt8Avx2;
+        kernel.int8_name = "avx2";
+        if (__builtin_cpu_supports("fma")) {
+            kernel.block = gemmBlockAvx2;
+            kernel.dot = dotAvx2;
+            kernel.name = "avx2";
+        }
+    }
+#elif defined(GEMM_NEON)
+    kernel.dot_int8 = dotInt8Neon;
+    kernel.int8_name = "neon";
+#endif
+    return kernel;
+}
+
+const GemmKernel& kernel() {
+    static const GemmKernel selected = selectKernel();
+    return selected;
+}
+
+} // namespace
+
+void sgemm(int M, int N, int K, const float* A, int lda, const float* B, int ldb, float* C, int ldc,
+           const float* bias, bool relu, WorkerPool& pool) {
+    GemmArgs args = {K, A, lda, B, ldb, C, ldc, bias, relu};
+    GemmBlockFunc block = kernel().block;
+
+    int row_blocks = (M + kRowBlock - 1) / kRowBlock;
+    int col_blocks = (N + kColBlock - 1) / kColBlock;
+    pool.parallelFor(static_cast<size_t>(row_blocks) * col_blocks, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; ++t) {
+            // 同一列块的行块相邻，连续的块共享 B 的子块
+            int n0 = static_cast<int>(t / row_blocks) * kColBlock;
+            int m0 = static_cast<int>(t % row_blocks) * kRowBlock;
+            block(args, m0, std::min(m0 + kRowBlock, M), n0, std::min(n0 + kColBlock, N));
+        }
+    });
+}
+
+void denseForward(const float* X, int batch, int K, const float* W, const float* bias, int outDim, float* Y,
+                  bool relu, WorkerPool& pool) {
+    DotFunc dot = kernel().dot;
+    // 权重远大于输入，每行权重只读一次，依次与批次中的每个输入做点积
+    pool.parallelFor(static_cast<size_t>(outDim), [&](size_t begin, size_t end) {
+        for (size_t o = begin; o < end; ++o) {
+            const float* w = W + o * static_cast<size_t>(K);
+            for (int b = 0; b < batch; ++b) {
+                float value = dot(w, X + static_cast<size_t>(b) * K, K) + (bias ? bias[o] : 0.0f);
+                Y[static_cast<size_t>(b) * outDim + o] = relu ? std::max(value, 0.0f) : value;
+            }
+        }
+    });
+}
+
+void denseForwardInt8(const float* X, int batch, int K, float inputScale, const int8_t* W, const float* weightScale,
+                      const float* bias, int outDim, float* Y, bool relu, std::vector<uint8_t>& quantized,
+                      WorkerPool& pool) {
+    // 输入量化：四舍五入到 0~127，超出校准范围的值截断
+    quantized.resize(static_cast<size_t>(batch) * K);
+    float inv_scale = 1.0f / inputScale;
+    for (size_t i = 0; i < quantized.size(); ++i) {
+        float q = X[i] * inv_scale + 0.5f;
+        quantized[i] = static_cast<uint8_t>(q <= 0.0f ? 0.0f : (q >= 127.0f ? 127.0f : q));
+    }
+
+    DotInt8Func dot = kernel().dot_int8;
+    const uint8_t* q = quantized.data();
+    pool.parallelFor(static_cast<size_t>(outDim), [&](size_t begin, size_t end) {
+        for (size_t o = begin; o < end; ++o) {
+            const int8_t* w = W + o * static_cast<size_t>(K);
+            float scale = inputScale * weightScale[o];
+            for (int b = 0; b < batch; ++b) {
+                float value = dot(q + static_cast<size_t>(b) * K, w, K) * scale + (bias ? bias[o] : 0.0f);
+                Y[static_cast<size_t>(b) * outDim + o] = relu ? std::max(value, 0.0f) : value;
+            }
+        }
+    });
+}
+
+const char* gemmKernelName() {
+    return kernel().name;
+}
+
+const char* int8KernelName() {
+    return kernel().int8_name;
+}
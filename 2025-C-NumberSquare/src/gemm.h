@@ -0,0 +1,32 @@
+#ifndef GEMM_H
+#define GEMM_H
+
+#include <cstdint>
+#include <vector>
+#include "worker_pool.h"
+
+// 单精度矩阵乘：C[M x N] = A[M x K] * B[K x N] + bias，全部为行主序
+// bias 按行相加（可为 nullptr），relu 为 true 时对结果取 max(0, x)；
+// 按 (行块, 列块) 切分后由 pool 并行计算，块内使用 4x16 的寄存器分块内核
+void sgemm(int M, int N, int K, const float* A, int lda, const float* B, int ldb, float* C, int ldc,
+           const float* bias, bool relu, WorkerPool& pool);
+
+// 全连接层：Y[batch x outDim] = X[batch x K] * W[outDim x K]^T + bias
+// W 为 PyTorch nn.Linear 的权重布局，按输出维度切分后并行计算
+void denseForward(const float* X, int batch, int K, const float* W, const float* bias, int outDim, float* Y,
+                  bool relu, WorkerPool& pool);
+
+// INT8 全连接层：Y[batch x outDim] = dequant(quant(X) * W^T) + bias
+// X 必须非负（ReLU 输出），按 inputScale 量化为 0~127，缓存在 quantized 中；
+// W 为按输出通道对称量化的 int8 权重，int32 累加后乘以 inputScale * weightScale[o] 还原
+void denseForwardInt8(const float* X, int batch, int K, float inputScale, const int8_t* W, const float* weightScale,
+                      const float* bias, int outDim, float* Y, bool relu, std::vector<uint8_t>& quantized,
+                      WorkerPool& pool);
+
+// 当前 CPU 使用的内核名称（avx2 / scalar）
+const char* gemmKernelName();
+
+// 当前 CPU 使用的 INT8 内核名称（avx2 / neon / scalar）
+const char* int8KernelName();
+
+#endif // GEMM_H
@@ -1,24 +1,95 @@
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
 #include "python_wrapper.h"
+#include "recognition_service.h"
+#include "recognition_cache.h"
+#include "square_net.h"
 
-int main(int argc, char* argv[]) {
-    // 初始化Python解释器
-    if (!initPython()) {
-        std::cerr << "Failed to initialize Python interpreter" << std::endl;
+// 使用 C++ SquareNet 推理，不启动 Python 解释器
+static int runNative(const std::string& weightsPath) {
+    SquareNet net;
+    if (!net.loadWeights(weightsPath)) {
+        std::cerr << "Failed to load model" << std::endl;
         return 1;
     }
 
-    // 创建Python包装器
-    PythonWrapper wrapper;
+    std::cout << "模型加载成功（C++ 推理，内核 " << net.kernelName() << "），等待图像输入..." << std::endl;
 
-    // 加载模型
-    if (!wrapper.loadModel("../models/best_epoch_weights.pth")) {
-        std::cerr << "Failed to load model" << std::endl;
-        cleanupPython();
+    // 主循环
+    std::string imagePath;
+    std::vector<cv::Mat> images(1);
+    std::vector<RecognitionResult> results;
+    while (true) {
+        std::cout << "请输入图像路径 (输入'q'退出): ";
+        if (!std::getline(std::cin, imagePath) || imagePath == "q" || imagePath == "Q") {
+            break;
+        }
+
+        images[0] = cv::imread(imagePath);
+        if (images[0].empty()) {
+            std::cout << "识别结果: 错误: 无法读取图像: " << imagePath << std::endl;
+            continue;
+        }
+
+        // 识别图像中的正方形
+        if (net.classify(images, results)) {
+            std::cout << "识别结果: 识别到正方形编号: " << results[0].classId << "（置信度 " << results[0].confidence
+                      << "）" << std::endl;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // --native <权重文件>：使用 export_weights.py 导出的权重在 C++ 中推理，不启动 Python
+    // --model <路径>：Python 推理使用的模型文件
+    // --cache <容量>：识别结果缓存的条目数，0 表示不缓存
+    // --hamming <距离>：视为同一图像的最大汉明距离，默认 0（只复用完全相同的图像）；
+    //   输入是整幅图像而不是矫正后的正方形裁剪图，放宽后相似的正方形可能得到别的数字
+    std::string nativeWeights;
+    std::string modelPath = "../models/best_epoch_weights.pth";
+    size_t cacheCapacity = 256;
+    int maxDistance = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--native" && i + 1 < argc) {
+            nativeWeights = argv[++i];
+        } else if (arg == "--model" && i + 1 < argc) {
+            modelPath = argv[++i];
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cacheCapacity = static_cast<size_t>(std::max(0, atoi(argv[++i])));
+        } else if (arg == "--hamming" && i + 1 < argc) {
+            maxDistance = atoi(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            std::cerr << "Usage: " << argv[0]
+                      << " [--native <weights>] [--model <path>] [--cache <entries>] [--hamming <distance>]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    if (!nativeWeights.empty()) {
+        return runNative(nativeWeights);
+    }
+
+    // Python 推理由识别服务的专用线程执行，解释器在该线程中初始化和清理；
+    // 交互输入一次只有一张图像，不需要等待合并
+    RecognitionService service(modelPath, 16, 0);
+    if (!service.start()) {
         return 1;
     }
 
+    // 识别经过结果缓存，未命中时提交给识别服务
+    RecognitionCache cache([&service](const cv::Mat& image, RecognitionResult& result) {
+        result = service.submit(image).get();
+        return result.classId >= 0;
+    }, cacheCapacity, maxDistance);
+
     std::cout << "模型加载成功，等待图像输入..." << std::endl;
 
     // 主循环
@@ -32,12 +103,21 @@ int main(int argc, char* argv[]) {
         }
 
         // 识别图像中的正方形
-        std::string result = wrapper.recognizeSquare(imagePath);
-        std::cout << "识别结果: " << result << std::endl;
+        RecognitionResult result;
+        if (cache.recognize(imagePath, result)) {
+            std::cout << "识别结果: 识别到正方形编号: " << result.classId << "（置信度 " << result.confidence << "）"
+                      << std::endl;
+        } else {
+            std::cout << "识别结果: 错误: 识别失败: " << imagePath << std::endl;
+        }
     }
 
-    // 清理Python解释器
-    cleanupPython();
+    RecognitionCache::Stats stats = cache.stats();
+    std::cout << "缓存统计: 命中 " << stats.hits << "（近似 " << stats.near_hits << "），未命中 " << stats.misses
+              << "，淘汰 " << stats.evictions << "，条目 " << stats.entries << std::endl;
+
+    // 停止识别服务并清理Python解释器
+    service.stop();
 
     return 0;
 }
\ No newline at end of file
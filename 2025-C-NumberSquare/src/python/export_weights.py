@@ -0,0 +1,54 @@
+import argparse
+import struct
+
+import torch
+
+from src.python.infer import SquareNet
+from src.python.weights_file import write_weights
+
+# 参考数据格式，用于检查 C++ 推理结果：
+#   "SQNR" | uint32 批次大小 | uint32 类别数 | float32 输入 (N, 3, 128, 128) | float32 输出 (N, 类别数)
+REFERENCE_MAGIC = b"SQNR"
+
+
+# 加载 PyTorch 权重
+def load_state(model_path):
+    model = SquareNet()
+    model.load_state_dict(torch.load(model_path, map_location="cpu"))
+    model.eval()
+    return model
+
+
+# 导出全部张量（weights_file.py 的对齐格式，C++ 推理和 infer.load_model 都可以直接 mmap）
+def export_weights(model, output_path):
+    state = model.state_dict()
+    write_weights(output_path, [(name, tensor.detach().cpu().numpy()) for name, tensor in state.items()])
+    print(f"权重已导出: {output_path}（{len(state)} 个张量）")
+
+
+# 用固定随机种子生成输入，保存输入和 PyTorch 的输出
+def export_reference(model, output_path, batch):
+    torch.manual_seed(0)
+    inputs = torch.rand(batch, 3, 128, 128)
+    with torch.no_grad():
+        outputs = model(inputs)
+    with open(output_path, "wb") as f:
+        f.write(REFERENCE_MAGIC)
+        f.write(struct.pack("<II", batch, outputs.shape[1]))
+        f.write(inputs.numpy().astype("<f4").tobytes())
+        f.write(outputs.numpy().astype("<f4").tobytes())
+    print(f"参考数据已导出: {output_path}（批次 {batch}）")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="导出 SquareNet 权重供 C++ 推理和快速启动使用")
+    parser.add_argument("model_path", help="PyTorch 权重文件，如 models/best_epoch_weights.pth")
+    parser.add_argument("output_path", help="输出的权重文件，如 models/square_net.bin")
+    parser.add_argument("--reference", help="同时导出参考输入输出，用于 square_net_check 校验")
+    parser.add_argument("--batch", type=int, default=4, help="参考数据的批次大小")
+    args = parser.parse_args()
+
+    model = load_state(args.model_path)
+    export_weights(model, args.output_path)
+    if args.reference:
+        export_reference(model, args.reference, args.batch)
@@ -34,14 +34,29 @@ class SquareNet(nn.Module):
 model = None
 device = torch.device('cuda' if torch.cuda.is_available() else 'cpu')
 
+# 从 export_weights.py 导出的权重文件加载参数：参数直接使用 mmap 映射的内存，
+# 不经过 pickle 解析和拷贝，页面在第一次推理时才换入，多个进程共享同一份物理页
+def load_mapped_weights(model, model_path):
+    from src.python.weights_file import load_weights
+    tensors = load_weights(model_path)
+    for name, param in model.named_parameters():
+        if name not in tensors or tuple(tensors[name].shape) != tuple(param.shape):
+            raise ValueError(f"权重文件缺少张量或形状不符: {name}")
+        if tensors[name].dtype != np.float32:
+            raise ValueError(f"Python 推理只支持 float32 权重，int8 量化权重请使用 C++ 推理: {name}")
+        param.data = torch.from_numpy(tensors[name])
+
 # 加载模型
 def load_model(model_path):
     global model
     try:
         # 创建模型实例
         model = SquareNet()
-        # 加载模型权重
-        model.load_state_dict(torch.load(model_path, map_location=device))
+        # 加载模型权重：.bin 为 export_weights.py 导出的对齐权重文件，直接映射；否则按 PyTorch 权重文件读取
+        if model_path.endswith(".bin"):
+            load_mapped_weights(model, model_path)
+        else:
+            model.load_state_dict(torch.load(model_path, map_location=device))
         model.to(device)
         model.eval()
         print(f"模型加载成功: {model_path}")
@@ -50,19 +65,25 @@ def load_model(model_path):
         print(f"模型加载失败: {e}")
         return False
 
-# 预处理图像
-def preprocess_image(image_path):
+# 把内存中的图像（BGR 或灰度，uint8）缩放为 128x128 的 RGB 图像
+def resize_to_input(image):
+    # 转换为numpy数组（对 C++ 端传入的缓冲区对象不拷贝）
+    image = np.asarray(image, dtype=np.uint8)
+    if image.ndim == 3 and image.shape[2] == 1:
+        image = image[:, :, 0]
+
+    # 调整图像大小（同时生成新数组，之后不再引用输入缓冲区）
+    image = cv2.resize(image, (128, 128))
+
+    # 转换为RGB格式
+    if image.ndim == 2:
+        return cv2.cvtColor(image, cv2.COLOR_GRAY2RGB)
+    return cv2.cvtColor(image, cv2.COLOR_BGR2RGB)
+
+# 预处理内存中的图像（BGR 或灰度，uint8）
+def preprocess_array(image):
     try:
-        # 读取图像
-        image = cv2.imread(image_path)
-        if image is None:
-            return None
-        
-        # 调整图像大小
-        image = cv2.resize(image, (128, 128))
-        
-        # 转换为RGB格式
-        image = cv2.cvtColor(image, cv2.COLOR_BGR2RGB)
+        image = resize_to_input(image)
         
         # 归一化
         image = image / 255.0
@@ -78,6 +99,14 @@ def preprocess_image(image_path):
         print(f"图像预处理失败: {e}")
         return None
 
+# 预处理图像
+def preprocess_image(image_path):
+    # 读取图像
+    image = cv2.imread(image_path)
+    if image is None:
+        return None
+    return preprocess_array(image)
+
 # 后处理结果
 def postprocess_result(output):
     # 获取预测类别
@@ -102,6 +131,10 @@ def infer(image_path):
     if image_tensor is None:
         return "错误: 图像预处理失败"
     
+    return run_inference(image_tensor)
+
+# 对预处理后的张量推理并后处理
+def run_inference(image_tensor):
     # 进行推理
     with torch.no_grad():
         output = model(image_tensor)
@@ -111,6 +144,48 @@ def infer(image_path):
     
     return result
 
+# 推理函数（内存图像）
+# image 为 (高, 宽, 通道) 的 uint8 只读缓冲区对象，C++ 端零拷贝传入；
+# 函数返回后不应保留对它（或由它得到的数组）的引用，否则 C++ 端会给出警告
+def infer_array(image):
+    global model
+    if model is None:
+        return "错误: 模型未加载"
+    
+    # 预处理图像
+    image_tensor = preprocess_array(image)
+    if image_tensor is None:
+        return "错误: 图像预处理失败"
+    
+    return run_inference(image_tensor)
+
+# 批量推理函数（内存图像）
+# images 为 infer_array 所接受图像的列表，全部堆叠为一个批次做一次前向推理
+# 返回与输入等长的 [(类别ID, 置信度), ...]，失败时返回 None
+def infer_batch(images):
+    global model
+    if model is None:
+        print("错误: 模型未加载")
+        return None
+    if len(images) == 0:
+        return []
+    
+    try:
+        # 预处理并堆叠为 (N, 3, 128, 128)
+        batch = np.stack([resize_to_input(image) for image in images])
+        batch = torch.from_numpy(batch.transpose(0, 3, 1, 2)).float().div_(255.0)
+        batch = batch.to(device)
+    except Exception as e:
+        print(f"图像预处理失败: {e}")
+        return None
+    
+    # 进行推理
+    with torch.no_grad():
+        output = model(batch)
+        confidence, predicted = torch.max(torch.softmax(output, dim=1), 1)
+    
+    return [(int(c), float(p)) for c, p in zip(predicted.tolist(), confidence.tolist())]
+
 # 测试代码（如果直接运行此脚本）
 if __name__ == '__main__':
     # 加载模型
@@ -0,0 +1,140 @@
+import argparse
+
+import cv2
+import torch
+from torch.utils.data import DataLoader, Subset
+
+from src.python.dataset import SquareDataset
+from src.python.export_weights import load_state
+from src.python.weights_file import write_weights
+
+# 量化权重文件使用 weights_file.py 的格式，由 C++ 的 SquareNet::loadWeights 读取：
+# 全连接层权重按输出通道对称量化为 int8（<name>.weight），另存每个通道的缩放（<name>.weight_scale）
+# 和校准得到的输入缩放（<name>.input_scale）；卷积层权重只占模型的很小一部分，仍为 float32
+
+QUANTIZED_LAYERS = ("fc1", "fc2")
+
+
+# 与 infer.py、SquareNet::preprocess 相同的预处理（SquareDataset 已转换为 RGB）
+def inference_transform(image):
+    image = cv2.resize(image, (128, 128)) / 255.0
+    return torch.from_numpy(image.transpose(2, 0, 1)).float()
+
+
+def make_loader(data_dir, limit, batch_size):
+    dataset = SquareDataset(data_dir, transform=inference_transform)
+    if limit and limit < len(dataset):
+        dataset = Subset(dataset, range(limit))
+    return DataLoader(dataset, batch_size=batch_size, shuffle=False)
+
+
+# 校准：统计全连接层输入的分布，取 percentile 分位数作为量化上限
+# 输入都是 ReLU 的输出，非负，量化为 0~127
+def calibrate(model, loader, percentile):
+    ranges = {name: 0.0 for name in QUANTIZED_LAYERS}
+
+    def observe(name):
+        def hook(module, inputs):
+            values = inputs[0].detach().flatten()
+            k = max(1, int(round(values.numel() * percentile / 100.0)))
+            ranges[name] = max(ranges[name], values.kthvalue(k).values.item())
+        return hook
+
+    handles = [getattr(model, name).register_forward_pre_hook(observe(name)) for name in QUANTIZED_LAYERS]
+    with torch.no_grad():
+        for images, _ in loader:
+            model(images)
+    for handle in handles:
+        handle.remove()
+    return {name: max(value, 1e-8) / 127.0 for name, value in ranges.items()}
+
+
+# 按输出通道（行）对称量化到 -127~127
+def quantize_weight(weight):
+    scale = weight.abs().amax(dim=1).clamp(min=1e-8) / 127.0
+    q = torch.clamp(torch.round(weight / scale[:, None]), -127, 127).to(torch.int8)
+    return q, scale
+
+
+# 模拟 C++ 的 int8 全连接层：输入四舍五入到 0~127，整数累加（double 下精确），再乘以两个缩放还原
+def quantized_linear(x, q, weight_scale, input_scale, bias):
+    xq = torch.clamp(torch.floor(x / input_scale + 0.5), 0, 127).double()
+    acc = xq @ q.double().t()
+    return (acc * (input_scale * weight_scale.double())).float() + bias
+
+
+def forward_quantized(model, params, x):
+    x = model.pool1(model.relu1(model.conv1(x)))
+    x = model.pool2(model.relu2(model.conv2(x)))
+    x = model.pool3(model.relu3(model.conv3(x)))
+    x = x.view(-1, 128 * 16 * 16)
+    x = model.relu4(quantized_linear(x, *params["fc1"], model.fc1.bias))
+    return quantized_linear(x, *params["fc2"], model.fc2.bias)
+
+
+# 精度报告：float 与 int8 各自的准确率、预测一致率和 logits 最大误差
+def report(model, params, loader):
+    total = float_correct = int8_correct = agree = 0
+    max_diff = 0.0
+    with torch.no_grad():
+        for images, labels in loader:
+            reference = model(images)
+            quantized = forward_quantized(model, params, images)
+            float_pred = reference.argmax(dim=1)
+            int8_pred = quantized.argmax(dim=1)
+            total += labels.size(0)
+            float_correct += (float_pred == labels).sum().item()
+            int8_correct += (int8_pred == labels).sum().item()
+            agree += (float_pred == int8_pred).sum().item()
+            max_diff = max(max_diff, (reference - quantized).abs().max().item())
+
+    if total == 0:
+        print("没有可用于评估的图像")
+        return
+    print(f"评估图像: {total}")
+    print(f"float32 准确率: {100.0 * float_correct / total:.2f}%")
+    print(f"int8    准确率: {100.0 * int8_correct / total:.2f}%")
+    print(f"预测一致率: {100.0 * agree / total:.2f}%，logits 最大误差: {max_diff:.4f}")
+
+
+def export_quantized(model, params, output_path):
+    state = model.state_dict()
+    quantized_names = {name + ".weight" for name in QUANTIZED_LAYERS}
+    float_bytes = sum(tensor.numel() * 4 for tensor in state.values())
+    tensors = [(name, tensor.detach().cpu().numpy()) for name, tensor in state.items() if name not in quantized_names]
+    for name in QUANTIZED_LAYERS:
+        q, weight_scale, input_scale = params[name]
+        tensors.append((name + ".weight", q.numpy()))
+        tensors.append((name + ".weight_scale", weight_scale.numpy()))
+        tensors.append((name + ".input_scale", torch.tensor([input_scale]).numpy()))
+    write_weights(output_path, tensors)
+    int8_bytes = sum(data.nbytes if data.dtype == "int8" else data.size * 4 for _, data in tensors)
+    print(f"量化权重已导出: {output_path}（权重 {float_bytes / 2**20:.1f} MiB -> {int8_bytes / 2**20:.1f} MiB）")
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description="SquareNet 训练后 int8 量化：校准、精度报告并导出权重")
+    parser.add_argument("model_path", help="PyTorch 权重文件，如 models/best_epoch_weights.pth")
+    parser.add_argument("calib_dir", help="校准数据目录，SquareDataset 格式（<类别ID>/<图像>）")
+    parser.add_argument("output_path", help="输出的量化权重文件，如 models/square_net_int8.bin")
+    parser.add_argument("--val-dir", help="精度报告使用的数据目录，默认使用校准数据")
+    parser.add_argument("--limit", type=int, default=512, help="最多使用的校准图像数，0 表示全部")
+    parser.add_argument("--percentile", type=float, default=99.99, help="激活值量化上限取的分位数")
+    parser.add_argument("--batch", type=int, default=32, help="批次大小")
+    args = parser.parse_args()
+
+    model = load_state(args.model_path)
+    calib_loader = make_loader(args.calib_dir, args.limit, args.batch)
+    input_scales = calibrate(model, calib_loader, args.percentile)
+
+    params = {}
+    for name in QUANTIZED_LAYERS:
+        layer = getattr(model, name)
+        q, weight_scale = quantize_weight(layer.weight.detach())
+        params[name] = (q, weight_scale, input_scales[name])
+        print(f"{name}: 输入缩放 {input_scales[name]:.6g}，权重缩放 {weight_scale.min().item():.3g}~"
+              f"{weight_scale.max().item():.3g}")
+
+    val_loader = make_loader(args.val_dir, 0, args.batch) if args.val_dir else calib_loader
+    report(model, params, val_loader)
+    export_quantized(model, params, args.output_path)
@@ -0,0 +1,96 @@
+import os
+import struct
+
+import numpy as np
+
+# SquareNet 权重文件（版本 3），C++ 端由 WeightsFile 以只读 mmap 方式直接使用，全部为小端：
+#   文件头 64 字节: "SQNW" | uint32 版本 | uint32 张量数 | uint32 对齐 | uint64 文件长度 | 保留
+#   张量表: 每项 96 字节: char 名称[56]（以 0 结尾）| uint32 数据类型 | uint32 维数 | uint32 形状[4]
+#           | uint64 数据偏移 | uint64 数据字节数
+#   张量数据: 偏移按 64 字节对齐，文件长度同样补齐
+# 运行中的识别进程直接映射该文件（C++ 为 MAP_SHARED，Python 为写时复制），文件绝不能原地修改：
+# 截断会使这些进程在下次访问页面时收到 SIGBUS，等长覆盖会在它们不知情时替换正在使用的权重；
+# 更新权重必须写出新文件再原子替换（见 write_weights），已有映射继续引用旧文件
+WEIGHTS_MAGIC = b"SQNW"
+WEIGHTS_VERSION = 3
+ALIGNMENT = 64
+HEADER_FORMAT = "<4sIIIQ"
+HEADER_SIZE = 64
+ENTRY_FORMAT = "<56sII4IQQ"
+ENTRY_SIZE = 96
+NAME_SIZE = 56
+MAX_DIMS = 4
+
+DTYPE_FLOAT32 = 0
+DTYPE_INT8 = 1
+NUMPY_DTYPES = {DTYPE_FLOAT32: np.dtype("<f4"), DTYPE_INT8: np.dtype("i1")}
+
+
+def align(offset):
+    return (offset + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+# 写出权重文件（原子替换 path，见文件开头的说明），tensors 为 [(名称, numpy 数组), ...]；int8 数组按 int8 保存，其余转换为 float32
+def write_weights(path, tensors):
+    entries = []
+    offset = align(HEADER_SIZE + ENTRY_SIZE * len(tensors))
+    for name, array in tensors:
+        if array.dtype == np.int8:
+            dtype, data = DTYPE_INT8, np.ascontiguousarray(array)
+        else:
+            dtype, data = DTYPE_FLOAT32, np.ascontiguousarray(array, dtype="<f4")
+        encoded = name.encode("utf-8")
+        if len(encoded) >= NAME_SIZE or data.ndim > MAX_DIMS:
+            raise ValueError(f"无法保存张量 {name}：名称过长或维数超过 {MAX_DIMS}")
+        entries.append((encoded, dtype, data, offset))
+        offset = align(offset + data.nbytes)
+    file_size = offset
+
+    # 先完整写出临时文件并落盘，再用 rename 原子替换：已映射旧文件的进程继续使用旧 inode，
+    # 新打开的进程看到完整的新文件，任何时刻都不会看到写了一半的文件
+    tmp_path = path + ".tmp"
+    try:
+        with open(tmp_path, "wb") as f:
+            f.write(struct.pack(HEADER_FORMAT, WEIGHTS_MAGIC, WEIGHTS_VERSION, len(entries), ALIGNMENT,
+                                file_size).ljust(HEADER_SIZE, b"\0"))
+            for encoded, dtype, data, data_offset in entries:
+                dims = list(data.shape) + [0] * (MAX_DIMS - data.ndim)
+                f.write(struct.pack(ENTRY_FORMAT, encoded, dtype, data.ndim, *dims, data_offset, data.nbytes))
+            for _, _, data, data_offset in entries:
+                f.write(b"\0" * (data_offset - f.tell()))
+                f.write(data.tobytes())
+            f.write(b"\0" * (file_size - f.tell()))
+            f.flush()
+            os.fsync(f.fileno())
+        os.replace(tmp_path, path)
+    except BaseException:
+        if os.path.exists(tmp_path):
+            os.remove(tmp_path)
+        raise
+
+    # 同步目录项，保证掉电后替换依然生效
+    dir_fd = os.open(os.path.dirname(os.path.abspath(path)), os.O_RDONLY)
+    try:
+        os.fsync(dir_fd)
+    finally:
+        os.close(dir_fd)
+
+
+# 以写时复制方式映射权重文件，返回 {名称: numpy 数组}，数组直接指向映射内存：
+# 页面在首次访问时换入，未被修改的页面与其他进程共享页缓存
+def load_weights(path):
+    mapped = np.memmap(path, dtype=np.uint8, mode="c")
+    magic, version, count, alignment, file_size = struct.unpack_from(HEADER_FORMAT, mapped, 0)
+    if magic != WEIGHTS_MAGIC or version != WEIGHTS_VERSION or file_size != mapped.size:
+        raise ValueError(f"不是版本 {WEIGHTS_VERSION} 的权重文件: {path}")
+
+    tensors = {}
+    for i in range(count):
+        name, dtype, ndim, d0, d1, d2, d3, offset, nbytes = struct.unpack_from(
+            ENTRY_FORMAT, mapped, HEADER_SIZE + i * ENTRY_SIZE)
+        if dtype not in NUMPY_DTYPES or ndim > MAX_DIMS or offset % alignment or offset + nbytes > file_size:
+            raise ValueError(f"权重文件中的张量表无效: {path}")
+        shape = (d0, d1, d2, d3)[:ndim]
+        tensors[name.rstrip(b"\0").decode("utf-8")] = \
+            mapped[offset:offset + nbytes].view(NUMPY_DTYPES[dtype]).reshape(shape)
+    return tensors
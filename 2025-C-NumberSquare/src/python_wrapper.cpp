@@ -6,8 +6,117 @@
 // 全局变量，用于存储Python模块指针
 static PyObject* pModule = nullptr;
 static PyObject* pInferFunc = nullptr;
+static PyObject* pInferArrayFunc = nullptr;
+static PyObject* pInferBatchFunc = nullptr;
 static PyObject* pLoadModelFunc = nullptr;
 
+// initPython 所在线程的线程状态，初始化完成后保存在这里并释放 GIL
+static PyThreadState* pMainThreadState = nullptr;
+
+// GIL 作用域锁：任意线程都可以调用 Python，只在调用期间持有 GIL
+class GilLock {
+public:
+    GilLock() : state_(PyGILState_Ensure()) {}
+    ~GilLock() { PyGILState_Release(state_); }
+
+private:
+    PyGILState_STATE state_;
+};
+
+// 以只读缓冲区协议导出 Mat 像素的 Python 对象，不拷贝数据
+// 对象持有 Mat 的一个引用（Mat 自带引用计数），即使 Python 端在调用结束后仍保留由它得到的数组，
+// 像素内存也不会被释放；exports 记录尚未释放的缓冲区视图数，调用返回后据此发现保留了图像的被调函数
+struct MatViewObject {
+    PyObject_HEAD
+    cv::Mat* mat; // 导出的图像
+    Py_ssize_t shape[3]; // (行, 列, 通道)
+    Py_ssize_t strides[3]; // 行步长使用 Mat::step，ROI 等非连续图像同样不需要拷贝
+    Py_ssize_t exports; // 尚未释放的缓冲区视图数
+};
+
+static int matViewGetBuffer(PyObject* self, Py_buffer* view, int flags) {
+    MatViewObject* matView = reinterpret_cast<MatViewObject*>(self);
+    const cv::Mat& image = *matView->mat;
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "image buffer is read-only");
+        return -1;
+    }
+
+    // 不接受步长的请求方按连续内存访问，只有连续图像可以满足；不支持 Fortran 顺序
+    bool wantsStrides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES;
+    bool wantsContiguous = (flags & PyBUF_C_CONTIGUOUS) == PyBUF_C_CONTIGUOUS ||
+                           (flags & PyBUF_ANY_CONTIGUOUS) == PyBUF_ANY_CONTIGUOUS;
+    if ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS ||
+        ((!wantsStrides || wantsContiguous) && !image.isContinuous())) {
+        PyErr_SetString(PyExc_BufferError, "image buffer is not contiguous");
+        return -1;
+    }
+
+    view->buf = image.data;
+    view->obj = self;
+    Py_INCREF(self);
+    // 只计像素本身：非连续图像最后一行之后不一定还有 step 长度的内存
+    view->len = static_cast<Py_ssize_t>(image.rows) * image.cols * static_cast<Py_ssize_t>(image.elemSize());
+    view->readonly = 1;
+    view->itemsize = 1;
+    view->format = (flags & PyBUF_FORMAT) ? (char*)"B" : nullptr;
+    view->ndim = 3;
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? matView->shape : nullptr;
+    view->strides = wantsStrides ? matView->strides : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+    ++matView->exports;
+    return 0;
+}
+
+static void matViewReleaseBuffer(PyObject* self, Py_buffer*) {
+    --reinterpret_cast<MatViewObject*>(self)->exports;
+}
+
+static void matViewDealloc(PyObject* self) {
+    delete reinterpret_cast<MatViewObject*>(self)->mat;
+    Py_TYPE(self)->tp_free(self);
+}
+
+static PyBufferProcs MatViewBufferProcs = {
+    matViewGetBuffer, // bf_getbuffer
+    matViewReleaseBuffer, // bf_releasebuffer
+};
+
+static PyTypeObject MatViewType = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    "python_wrapper.MatView", // tp_name
+    sizeof(MatViewObject), // tp_basicsize
+    0, // tp_itemsize
+    matViewDealloc, // tp_dealloc
+    0, // tp_vectorcall_offset
+    0, // tp_getattr
+    0, // tp_setattr
+    0, // tp_as_async
+    0, // tp_repr
+    0, // tp_as_number
+    0, // tp_as_sequence
+    0, // tp_as_mapping
+    0, // tp_hash
+    0, // tp_call
+    0, // tp_str
+    0, // tp_getattro
+    0, // tp_setattro
+    &MatViewBufferProcs, // tp_as_buffer
+    Py_TPFLAGS_DEFAULT, // tp_flags
+    "Read-only buffer over a cv::Mat", // tp_doc
+};
+
+// 注册 MatView 类型，在持有 GIL 时调用；类型已就绪时 PyType_Ready 直接返回
+static bool initMatViewType() {
+    if (PyType_Ready(&MatViewType) < 0) {
+        std::cerr << "Failed to initialize MatView type" << std::endl;
+        PyErr_Print();
+        return false;
+    }
+    return true;
+}
+
 // 初始化Python解释器
 bool initPython() {
     // 初始化Python
@@ -25,6 +134,11 @@ bool initPython() {
     PyList_Append(sysPath, currentPath);
     Py_DECREF(currentPath);
 
+    // 注册传递内存图像使用的缓冲区类型
+    if (!initMatViewType()) {
+        return false;
+    }
+
     // 导入Python模块
     pModule = PyImport_ImportModule((char*)"src.python.infer");
     if (!pModule) {
@@ -49,11 +163,58 @@ bool initPython() {
         return false;
     }
 
+    // 获取内存图像识别函数
+    pInferArrayFunc = PyObject_GetAttrString(pModule, (char*)"infer_array");
+    if (!pInferArrayFunc || !PyCallable_Check(pInferArrayFunc)) {
+        std::cerr << "Failed to get 'infer_array' function" << std::endl;
+        PyErr_Print();
+        return false;
+    }
+
+    // 获取批量识别函数
+    pInferBatchFunc = PyObject_GetAttrString(pModule, (char*)"infer_batch");
+    if (!pInferBatchFunc || !PyCallable_Check(pInferBatchFunc)) {
+        std::cerr << "Failed to get 'infer_batch' function" << std::endl;
+        PyErr_Print();
+        return false;
+    }
+
+    // 释放 GIL，之后各线程通过 GilLock 调用 Python；推理期间其他 Python 线程也能运行
+    pMainThreadState = PyEval_SaveThread();
     return true;
 }
 
-// 清理Python解释器
+// 解析识别函数返回的字符串
+static std::string resultToString(PyObject* pResult) {
+    if (!PyUnicode_Check(pResult)) {
+        return "Error: invalid result type";
+    }
+    const char* cStr = PyUnicode_AsUTF8(pResult);
+    if (!cStr) {
+        PyErr_Clear();
+        return "Error: failed to convert result to string";
+    }
+    return cStr;
+}
+
+// 清理Python解释器，必须在调用 initPython 的线程中调用
 void cleanupPython() {
+    // 重新取回 GIL
+    if (pMainThreadState) {
+        PyEval_RestoreThread(pMainThreadState);
+        pMainThreadState = nullptr;
+    }
+
+    if (pInferBatchFunc) {
+        Py_DECREF(pInferBatchFunc);
+        pInferBatchFunc = nullptr;
+    }
+
+    if (pInferArrayFunc) {
+        Py_DECREF(pInferArrayFunc);
+        pInferArrayFunc = nullptr;
+    }
+
     if (pInferFunc) {
         Py_DECREF(pInferFunc);
         pInferFunc = nullptr;
@@ -88,6 +249,7 @@ bool PythonWrapper::loadModel(const std::string& modelPath) {
     }
 
     // 准备函数参数
+    GilLock gil;
     PyObject* pArgs = PyTuple_New(1);
     PyTuple_SetItem(pArgs, 0, PyUnicode_FromString(modelPath.c_str()));
 
@@ -116,6 +278,7 @@ std::string PythonWrapper::recognizeSquare(const std::string& imagePath) {
     }
 
     // 准备函数参数
+    GilLock gil;
     PyObject* pArgs = PyTuple_New(1);
     PyTuple_SetItem(pArgs, 0, PyUnicode_FromString(imagePath.c_str()));
 
@@ -130,18 +293,165 @@ std::string PythonWrapper::recognizeSquare(const std::string& imagePath) {
     }
 
     // 解析结果
-    std::string result;
-    if (PyUnicode_Check(pResult)) {
-        const char* cStr = PyUnicode_AsUTF8(pResult);
-        if (cStr) {
-            result = cStr;
-        } else {
-            result = "Error: failed to convert result to string";
-        }
-    } else {
-        result = "Error: invalid result type";
+    std::string result = resultToString(pResult);
+    Py_DECREF(pResult);
+    return result;
+}
+
+// 检查图像是否可以传给 Python（8位 BGR 或灰度）
+static bool isSupportedImage(const cv::Mat& image) {
+    return !image.empty() && image.depth() == CV_8U && (image.channels() == 1 || image.channels() == 3);
+}
+
+// 把 Mat 包装为 MatView，不拷贝数据
+static PyObject* wrapImage(const cv::Mat& image) {
+    MatViewObject* matView = PyObject_New(MatViewObject, &MatViewType);
+    if (!matView) {
+        std::cerr << "Failed to create buffer for image" << std::endl;
+        PyErr_Print();
+        return nullptr;
+    }
+
+    // 引用外部内存的 Mat 没有引用计数，无法延长数据的寿命，只有这种情况拷贝一份
+    matView->mat = new cv::Mat(image.u ? image : image.clone());
+    matView->shape[0] = matView->mat->rows;
+    matView->shape[1] = matView->mat->cols;
+    matView->shape[2] = matView->mat->channels();
+    matView->strides[0] = static_cast<Py_ssize_t>(matView->mat->step[0]);
+    matView->strides[1] = static_cast<Py_ssize_t>(matView->mat->elemSize());
+    matView->strides[2] = 1;
+    matView->exports = 0;
+    return reinterpret_cast<PyObject*>(matView);
+}
+
+// 调用结束后释放包装对象；被调函数仍持有图像（缓冲区视图未释放或保留了对象本身）时，
+// 像素内存由 Mat 的引用计数保持有效，但调用方之后对 image 的修改会被 Python 端看到，因此给出警告
+static void releaseImage(PyObject* pView, const char* funcName) {
+    if (reinterpret_cast<MatViewObject*>(pView)->exports > 0 || Py_REFCNT(pView) > 1) {
+        std::cerr << "Warning: '" << funcName << "' kept a reference to the image buffer" << std::endl;
+    }
+    Py_DECREF(pView);
+}
+
+// 识别内存中的图像
+std::string PythonWrapper::recognizeSquare(const cv::Mat& image) {
+    if (!pInferArrayFunc) {
+        std::cerr << "'infer_array' function not initialized" << std::endl;
+        return "Error: function not initialized";
+    }
+    if (!isSupportedImage(image)) {
+        return "Error: expected a non-empty 8-bit BGR or grayscale image";
+    }
+
+    GilLock gil;
+    PyObject* pView = wrapImage(image);
+    if (!pView) {
+        return "Error: failed to wrap image";
+    }
+
+    // 调用Python函数
+    PyObject* pResult = PyObject_CallFunctionObjArgs(pInferArrayFunc, pView, nullptr);
+    releaseImage(pView, "infer_array");
+
+    if (!pResult) {
+        std::cerr << "Failed to call 'infer_array' function" << std::endl;
+        PyErr_Print();
+        return "Error: function call failed";
     }
 
+    // 解析结果
+    std::string result = resultToString(pResult);
     Py_DECREF(pResult);
     return result;
+}
+
+// 识别内存中的图像，结构化结果
+bool PythonWrapper::recognizeSquare(const cv::Mat& image, RecognitionResult& result) {
+    std::vector<cv::Mat> images(1, image);
+    std::vector<RecognitionResult> results;
+    if (!recognizeBatch(images, results)) {
+        return false;
+    }
+    result = results[0];
+    return true;
+}
+
+// 批量识别内存中的图像
+bool PythonWrapper::recognizeBatch(const std::vector<cv::Mat>& images, std::vector<RecognitionResult>& results) {
+    results.clear();
+    if (!pInferBatchFunc) {
+        std::cerr << "'infer_batch' function not initialized" << std::endl;
+        return false;
+    }
+    if (images.empty()) {
+        return true;
+    }
+    for (size_t i = 0; i < images.size(); ++i) {
+        if (!isSupportedImage(images[i])) {
+            std::cerr << "Image " << i << " is not a non-empty 8-bit BGR or grayscale image" << std::endl;
+            return false;
+        }
+    }
+
+    // 所有图像包装为 MatView 列表，一次调用、一次前向推理
+    GilLock gil;
+    PyObject* pList = PyList_New(static_cast<Py_ssize_t>(images.size()));
+    if (!pList) {
+        PyErr_Print();
+        return false;
+    }
+    std::vector<PyObject*> views;
+    views.reserve(images.size());
+    bool wrapped = true;
+    for (size_t i = 0; i < images.size(); ++i) {
+        PyObject* pView = wrapImage(images[i]);
+        if (!pView) {
+            wrapped = false;
+            break;
+        }
+        views.push_back(pView);
+        Py_INCREF(pView);
+        PyList_SET_ITEM(pList, static_cast<Py_ssize_t>(i), pView);
+    }
+
+    PyObject* pResult = nullptr;
+    if (wrapped) {
+        pResult = PyObject_CallFunctionObjArgs(pInferBatchFunc, pList, nullptr);
+    }
+    Py_DECREF(pList);
+    for (size_t i = 0; i < views.size(); ++i) {
+        releaseImage(views[i], "infer_batch");
+    }
+
+    if (!wrapped) {
+        return false;
+    }
+    if (!pResult) {
+        std::cerr << "Failed to call 'infer_batch' function" << std::endl;
+        PyErr_Print();
+        return false;
+    }
+
+    // 解析结果：与输入等长的 (类别ID, 置信度) 列表
+    bool ok = PyList_Check(pResult) && PyList_GET_SIZE(pResult) == static_cast<Py_ssize_t>(images.size());
+    for (Py_ssize_t i = 0; ok && i < PyList_GET_SIZE(pResult); ++i) {
+        PyObject* pItem = PyList_GET_ITEM(pResult, i);
+        RecognitionResult result;
+        ok = PyTuple_Check(pItem) && PyTuple_GET_SIZE(pItem) == 2;
+        if (ok) {
+            result.classId = static_cast<int>(PyLong_AsLong(PyTuple_GET_ITEM(pItem, 0)));
+            result.confidence = static_cast<float>(PyFloat_AsDouble(PyTuple_GET_ITEM(pItem, 1)));
+            ok = !PyErr_Occurred();
+        }
+        if (ok) {
+            results.push_back(result);
+        }
+    }
+    if (!ok) {
+        std::cerr << "Invalid result from 'infer_batch'" << std::endl;
+        PyErr_Clear();
+        results.clear();
+    }
+    Py_DECREF(pResult);
+    return ok;
 }
\ No newline at end of file
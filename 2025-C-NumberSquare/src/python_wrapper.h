@@ -2,8 +2,14 @@
 #define PYTHON_WRAPPER_H
 
 #include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "recognition_result.h"
 
+// 初始化解释器并导入推理模块；返回时已释放 GIL，PythonWrapper 可在任意线程使用（调用间由 GIL 串行化）
 bool initPython();
+
+// 清理解释器，必须在调用 initPython 的线程中调用
 void cleanupPython();
 
 class PythonWrapper {
@@ -16,6 +22,17 @@ public:
 
     // 识别正方形
     std::string recognizeSquare(const std::string& imagePath);
+
+    // 识别内存中的图像（8位 BGR 或灰度），图像数据以只读缓冲区对象零拷贝传给 Python，
+    // 不经过磁盘和 JPEG 编解码；调用期间不能修改 image（引用外部内存的 Mat 会先拷贝一份）
+    std::string recognizeSquare(const cv::Mat& image);
+
+    // 识别内存中的图像（要求同上），以结构化结果返回，失败时返回false，不依赖结果文本判断
+    bool recognizeSquare(const cv::Mat& image, RecognitionResult& result);
+
+    // 批量识别：所有图像（要求同上）堆叠为一个批次，只调用一次 Python、做一次前向推理；
+    // results 与 images 一一对应，失败时返回false且 results 为空
+    bool recognizeBatch(const std::vector<cv::Mat>& images, std::vector<RecognitionResult>& results);
 };
 
 #endif // PYTHON_WRAPPER_H
\ No newline at end of file
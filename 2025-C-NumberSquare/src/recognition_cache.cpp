@@ -0,0 +1,159 @@
+#include "recognition_cache.h"
+#include <iostream>
+
+namespace {
+
+const int kHashWidth = 9; // dHash 缩略图宽度（每行比较出 8 位）
+const int kHashHeight = 8; // dHash 缩略图高度
+
+int hammingDistance(uint64_t a, uint64_t b) {
+    return __builtin_popcountll(a ^ b);
+}
+
+} // namespace
+
+RecognitionCache::RecognitionCache(Recognizer recognizer, size_t capacity, int maxDistance)
+    : recognizer_(recognizer),
+      capacity_(capacity),
+      max_distance_(maxDistance < 0 ? 0 : (maxDistance > 64 ? 64 : maxDistance)),
+      hits_(0),
+      near_hits_(0),
+      misses_(0),
+      evictions_(0) {
+    // 构造函数初始化
+}
+
+RecognitionCache::RecognitionCache(PythonWrapper& wrapper, size_t capacity, int maxDistance)
+    : RecognitionCache([&wrapper](const cv::Mat& image, RecognitionResult& result) {
+          return wrapper.recognizeSquare(image, result);
+      }, capacity, maxDistance) {
+    // 构造函数初始化
+}
+
+bool RecognitionCache::recognize(const cv::Mat& image, RecognitionResult& result) {
+    if (image.empty() || image.depth() != CV_8U || (image.channels() != 1 && image.channels() != 3)) {
+        std::cerr << "Expected a non-empty 8-bit BGR or grayscale image" << std::endl;
+        return false;
+    }
+
+    uint64_t hash = dHash(image);
+    if (lookup(hash, result)) {
+        return true;
+    }
+
+    // 未命中：推理期间不持有锁，其他线程仍可查找；只缓存明确成功的结果
+    if (!recognizer_(image, result)) {
+        return false;
+    }
+    insert(hash, result);
+    return true;
+}
+
+bool RecognitionCache::recognize(const std::string& imagePath, RecognitionResult& result) {
+    cv::Mat image = cv::imread(imagePath);
+    if (image.empty()) {
+        std::cerr << "Failed to read image: " << imagePath << std::endl;
+        return false;
+    }
+    return recognize(image, result);
+}
+
+uint64_t RecognitionCache::dHash(const cv::Mat& image) {
+    // 先按区域平均缩小再转灰度，只需转换 72 个像素
+    cv::Mat small;
+    cv::resize(image, small, cv::Size(kHashWidth, kHashHeight), 0, 0, cv::INTER_AREA);
+
+    uint64_t hash = 0;
+    int channels = small.channels();
+    for (int y = 0; y < kHashHeight; ++y) {
+        const uint8_t* row = small.ptr<uint8_t>(y);
+        int luma[kHashWidth];
+        for (int x = 0; x < kHashWidth; ++x) {
+            const uint8_t* pixel = row + x * channels;
+            // BT.601 亮度的定点近似（B、G、R 权重 29/150/77）
+            luma[x] = channels == 3 ? (pixel[0] * 29 + pixel[1] * 150 + pixel[2] * 77) >> 8 : pixel[0];
+        }
+        for (int x = 0; x < kHashWidth - 1; ++x) {
+            hash = (hash << 1) | (luma[x] < luma[x + 1] ? 1 : 0);
+        }
+    }
+    return hash;
+}
+
+void RecognitionCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    lru_.clear();
+    index_.clear();
+}
+
+RecognitionCache::Stats RecognitionCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.near_hits = near_hits_;
+    stats.misses = misses_;
+    stats.evictions = evictions_;
+    stats.entries = lru_.size();
+    return stats;
+}
+
+bool RecognitionCache::lookup(uint64_t hash, RecognitionResult& result) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 哈希完全相同时直接查表
+    std::unordered_map<uint64_t, std::list<Entry>::iterator>::iterator found = index_.find(hash);
+    std::list<Entry>::iterator best = lru_.end();
+    if (found != index_.end()) {
+        best = found->second;
+    } else if (max_distance_ > 0) {
+        // 在容差内找汉明距离最小的条目，距离相同时取最近使用的；
+        // 容量为几百条时一次扫描只是几百次 popcount，不需要更复杂的索引
+        int best_distance = max_distance_ + 1;
+        for (std::list<Entry>::iterator it = lru_.begin(); it != lru_.end(); ++it) {
+            int distance = hammingDistance(hash, it->hash);
+            if (distance < best_distance) {
+                best_distance = distance;
+                best = it;
+            }
+        }
+        if (best != lru_.end()) {
+            ++near_hits_;
+        }
+    }
+
+    if (best == lru_.end()) {
+        ++misses_;
+        return false;
+    }
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, best);
+    result = best->result;
+    return true;
+}
+
+void RecognitionCache::insert(uint64_t hash, const RecognitionResult& result) {
+    if (capacity_ == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // 其他线程可能已插入同一哈希，更新即可
+    std::unordered_map<uint64_t, std::list<Entry>::iterator>::iterator found = index_.find(hash);
+    if (found != index_.end()) {
+        found->second->result = result;
+        lru_.splice(lru_.begin(), lru_, found->second);
+        return;
+    }
+
+    Entry entry;
+    entry.hash = hash;
+    entry.result = result;
+    lru_.push_front(entry);
+    index_[hash] = lru_.begin();
+
+    if (lru_.size() > capacity_) {
+        index_.erase(lru_.back().hash);
+        lru_.pop_back();
+        ++evictions_;
+    }
+}
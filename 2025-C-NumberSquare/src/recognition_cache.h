@@ -0,0 +1,83 @@
+#ifndef RECOGNITION_CACHE_H
+#define RECOGNITION_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include "recognition_result.h"
+#include "python_wrapper.h"
+
+// 识别结果缓存，放在 PythonWrapper::recognizeSquare（或其他识别函数）之前
+// 以图像的 dHash（缩小为 9x8 灰度图，比较左右相邻像素得到 64 位）为键，容量有限，按 LRU 淘汰；
+// 命中时直接返回缓存的结果，不再做 CNN 推理，同一个正方形在连续帧中反复出现时，识别退化为一次哈希计算和查找
+// 默认只接受哈希完全相同的图像；maxDistance 允许一定的汉明距离，但整幅图像缩到 9x8 后数字只占几个像素，
+// 只有数字占满画面的图像（如透视矫正后的正方形裁剪图）才适合放宽，否则相似的正方形可能得到别的数字
+// 只缓存识别函数明确报告成功的结果；可从多个线程调用，推理期间不持有缓存锁
+class RecognitionCache {
+public:
+    // 识别函数：成功时写入 result 并返回true
+    typedef std::function<bool(const cv::Mat& image, RecognitionResult& result)> Recognizer;
+
+    // 统计信息
+    struct Stats {
+        uint64_t hits; // 命中次数（含近似命中）
+        uint64_t near_hits; // 哈希不完全相同的近似命中次数
+        uint64_t misses; // 未命中次数（即实际推理次数）
+        uint64_t evictions; // 淘汰次数
+        size_t entries; // 当前缓存条目数
+    };
+
+    // capacity 为最多缓存的条目数（0 表示不缓存），maxDistance 为视为同一图像的最大汉明距离（0~64）
+    explicit RecognitionCache(Recognizer recognizer, size_t capacity = 256, int maxDistance = 0);
+
+    // 缓存 PythonWrapper::recognizeSquare 的结果
+    explicit RecognitionCache(PythonWrapper& wrapper, size_t capacity = 256, int maxDistance = 0);
+
+    // 识别内存中的图像（8位 BGR 或灰度），失败时返回false
+    bool recognize(const cv::Mat& image, RecognitionResult& result);
+
+    // 读取图像文件后识别，缓存按图像内容而不是路径查找
+    bool recognize(const std::string& imagePath, RecognitionResult& result);
+
+    // 计算图像（8位 BGR 或灰度）的 64 位 dHash
+    static uint64_t dHash(const cv::Mat& image);
+
+    // 清空缓存，统计信息保留
+    void clear();
+
+    // 获取统计信息
+    Stats stats() const;
+
+private:
+    // 一个缓存条目
+    struct Entry {
+        uint64_t hash; // 图像哈希
+        RecognitionResult result; // 识别结果
+    };
+
+    // 查找哈希相同或最接近且在容差内的条目，命中时移到 LRU 头部
+    bool lookup(uint64_t hash, RecognitionResult& result);
+
+    // 插入或更新条目，超出容量时淘汰最久未使用的条目
+    void insert(uint64_t hash, const RecognitionResult& result);
+
+    Recognizer recognizer_; // 实际执行识别
+    size_t capacity_; // 最大条目数
+    int max_distance_; // 最大汉明距离
+
+    std::list<Entry> lru_; // 按最近使用排序，头部最新
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index_; // 哈希精确查找
+    mutable std::mutex mutex_; // 保护缓存和统计
+
+    uint64_t hits_; // 命中次数
+    uint64_t near_hits_; // 近似命中次数
+    uint64_t misses_; // 未命中次数
+    uint64_t evictions_; // 淘汰次数
+};
+
+#endif // RECOGNITION_CACHE_H
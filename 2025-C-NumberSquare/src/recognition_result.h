@@ -0,0 +1,10 @@
+#ifndef RECOGNITION_RESULT_H
+#define RECOGNITION_RESULT_H
+
+// 单个识别结果
+struct RecognitionResult {
+    int classId;      // 类别ID
+    float confidence; // softmax 置信度（0~1）
+};
+
+#endif // RECOGNITION_RESULT_H
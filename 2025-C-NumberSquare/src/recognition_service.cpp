@@ -0,0 +1,247 @@
+#include "recognition_service.h"
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// 失败时返回的结果
+RecognitionResult failedResult() {
+    RecognitionResult result;
+    result.classId = -1;
+    result.confidence = 0.0f;
+    return result;
+}
+
+} // namespace
+
+RecognitionService::RecognitionService(const std::string& modelPath, size_t maxBatch, int64_t coalesceMicros)
+    : model_path_(modelPath),
+      max_batch_(maxBatch > 0 ? maxBatch : 1),
+      coalesce_(coalesceMicros > 0 ? coalesceMicros : 0),
+      inbox_(nullptr),
+      submitted_(0),
+      waiting_(false),
+      accepting_(false),
+      stop_(false),
+      requests_(0),
+      batches_(0),
+      failed_(0),
+      max_batch_seen_(0) {
+    // 构造函数初始化
+}
+
+RecognitionService::~RecognitionService() {
+    // 析构函数停止服务线程
+    stop();
+}
+
+bool RecognitionService::start() {
+    if (thread_.joinable()) {
+        return true;
+    }
+    stop_.store(false);
+    accepting_.store(true);
+
+    // 解释器和模型在服务线程中初始化，这里等待结果
+    std::promise<bool> ready;
+    std::future<bool> started = ready.get_future();
+    thread_ = std::thread(&RecognitionService::serviceThread, this, &ready);
+    if (!started.get()) {
+        thread_.join();
+        return false;
+    }
+    return true;
+}
+
+void RecognitionService::stop() {
+    stop_.store(true);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_cv_.notify_one();
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+std::future<RecognitionResult> RecognitionService::submit(const cv::Mat& image) {
+    Request* request = new Request;
+    std::future<RecognitionResult> future = request->promise.get_future();
+
+    // 不支持的图像直接失败，不进入批次，避免拖累同批次的其他请求
+    if (image.empty() || image.depth() != CV_8U || (image.channels() != 1 && image.channels() != 3)) {
+        request->promise.set_value(failedResult());
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        delete request;
+        return future;
+    }
+    request->image = image;
+    request->submitted = std::chrono::steady_clock::now();
+
+    // 无锁入栈；先增加计数，服务线程取出的个数不会超过计数
+    submitted_.fetch_add(1);
+    Request* top = inbox_.load(std::memory_order_relaxed);
+    do {
+        request->next = top;
+    } while (!inbox_.compare_exchange_weak(top, request));
+
+    // 服务线程先清除 accepting_ 再最后一次取出请求，与这里先入队再检查 accepting_ 配合，请求不会被遗漏
+    if (!accepting_.load()) {
+        failRemaining();
+        return future;
+    }
+
+    // 服务线程先置 waiting_ 再检查队列，与这里先入队再检查 waiting_ 配合，唤醒不会丢失
+    if (waiting_.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_cv_.notify_one();
+    }
+    return future;
+}
+
+RecognitionService::Stats RecognitionService::stats() const {
+    Stats stats;
+    stats.requests = requests_.load(std::memory_order_relaxed);
+    stats.batches = batches_.load(std::memory_order_relaxed);
+    stats.failed = failed_.load(std::memory_order_relaxed);
+    stats.max_batch = max_batch_seen_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void RecognitionService::serviceThread(std::promise<bool>* ready) {
+    // 解释器属于本线程；initPython 返回时已释放 GIL，之后只在调用 Python 期间持有
+    bool ok = initPython();
+    PythonWrapper wrapper;
+    if (!ok) {
+        std::cerr << "Failed to initialize Python interpreter" << std::endl;
+    } else if (!wrapper.loadModel(model_path_)) {
+        std::cerr << "Failed to load model" << std::endl;
+        ok = false;
+    }
+    if (!ok) {
+        accepting_.store(false);
+        failRemaining();
+        cleanupPython();
+        ready->set_value(false);
+        return;
+    }
+    ready->set_value(true);
+
+    Request* head = nullptr;
+    Request* tail = nullptr;
+    size_t pending = 0;
+    while (true) {
+        pending += takeRequests(head, tail);
+        if (pending == 0) {
+            // 停止时先处理完已提交的请求
+            if (stop_.load()) {
+                break;
+            }
+            sleepUntil(std::chrono::steady_clock::time_point(), false,
+                       [this]() { return inbox_.load() != nullptr || stop_.load(); });
+            continue;
+        }
+
+        // 合并：从最早的请求提交起最多等待 coalesce_，批次攒满或停止时提前结束；
+        // 推理期间积压的请求早已超过等待时间，直接处理
+        std::chrono::steady_clock::time_point deadline = head->submitted + coalesce_;
+        if (pending < max_batch_ && !stop_.load() && std::chrono::steady_clock::now() < deadline) {
+            sleepUntil(deadline, true,
+                       [this, pending]() { return pending + submitted_.load() >= max_batch_ || stop_.load(); });
+            pending += takeRequests(head, tail);
+        }
+
+        pending -= runBatch(wrapper, head, tail);
+    }
+
+    // 不再接受新请求，此后入队的请求由这里或提交方以失败完成
+    accepting_.store(false);
+    failRemaining();
+    cleanupPython();
+}
+
+size_t RecognitionService::takeRequests(Request*& head, Request*& tail) {
+    Request* taken = inbox_.exchange(nullptr);
+    if (!taken) {
+        return 0;
+    }
+
+    // 栈中为后进先出，反转为提交顺序
+    Request* last = taken;
+    Request* ordered = nullptr;
+    size_t count = 0;
+    while (taken) {
+        Request* next = taken->next;
+        taken->next = ordered;
+        ordered = taken;
+        taken = next;
+        ++count;
+    }
+    submitted_.fetch_sub(count);
+
+    if (tail) {
+        tail->next = ordered;
+    } else {
+        head = ordered;
+    }
+    tail = last;
+    return count;
+}
+
+template <typename Predicate>
+void RecognitionService::sleepUntil(std::chrono::steady_clock::time_point deadline, bool timed, Predicate wake) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    waiting_.store(true);
+    if (timed) {
+        wake_cv_.wait_until(lock, deadline, wake);
+    } else {
+        wake_cv_.wait(lock, wake);
+    }
+    waiting_.store(false);
+}
+
+size_t RecognitionService::runBatch(PythonWrapper& wrapper, Request*& head, Request*& tail) {
+    std::vector<Request*> batch;
+    std::vector<cv::Mat> images;
+    while (head && batch.size() < max_batch_) {
+        batch.push_back(head);
+        images.push_back(head->image);
+        head = head->next;
+    }
+    if (!head) {
+        tail = nullptr;
+    }
+
+    // 一次 infer_batch 调用；GIL 只在调用期间持有，PyTorch 算子内部还会再释放 GIL
+    std::vector<RecognitionResult> results;
+    bool ok = wrapper.recognizeBatch(images, results);
+    images.clear();
+    for (size_t i = 0; i < batch.size(); ++i) {
+        batch[i]->promise.set_value(ok ? results[i] : failedResult());
+        delete batch[i];
+    }
+
+    requests_.fetch_add(batch.size(), std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    if (!ok) {
+        failed_.fetch_add(batch.size(), std::memory_order_relaxed);
+    }
+    if (batch.size() > max_batch_seen_.load(std::memory_order_relaxed)) {
+        max_batch_seen_.store(batch.size(), std::memory_order_relaxed);
+    }
+    return batch.size();
+}
+
+void RecognitionService::failRemaining() {
+    Request* request = inbox_.exchange(nullptr);
+    size_t count = 0;
+    while (request) {
+        Request* next = request->next;
+        request->promise.set_value(failedResult());
+        delete request;
+        request = next;
+        ++count;
+    }
+    submitted_.fetch_sub(count);
+    failed_.fetch_add(count, std::memory_order_relaxed);
+}
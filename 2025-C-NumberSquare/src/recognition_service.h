@@ -0,0 +1,94 @@
+#ifndef RECOGNITION_SERVICE_H
+#define RECOGNITION_SERVICE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include "recognition_result.h"
+#include "python_wrapper.h"
+
+// 异步识别服务
+// 专用线程负责初始化 Python 解释器、加载模型并执行全部推理；任意线程都可以提交图像，
+// 提交只是一次无锁入队，立即返回 future，调用方不会被推理阻塞
+// 相隔很近（coalesceMicros 内）到达的请求，以及上一次推理期间积压的请求，合并为一次 infer_batch 调用
+// 服务线程空闲等待时不持有 GIL；本服务运行期间，不要在其他线程调用 initPython/cleanupPython
+class RecognitionService {
+public:
+    // 统计信息
+    struct Stats {
+        uint64_t requests; // 已完成的请求数
+        uint64_t batches; // 前向推理次数
+        uint64_t failed; // 失败的请求数
+        uint64_t max_batch; // 单次推理的最大批次
+    };
+
+    // maxBatch 为单次推理的最大图像数，coalesceMicros 为第一个请求到达后等待后续请求的最长时间
+    explicit RecognitionService(const std::string& modelPath, size_t maxBatch = 16, int64_t coalesceMicros = 2000);
+    ~RecognitionService();
+
+    // 启动服务线程，等待解释器初始化和模型加载完成
+    bool start();
+
+    // 处理完已提交的请求后停止服务线程并清理解释器，之后提交的请求立即失败
+    void stop();
+
+    // 提交一张图像（8位 BGR 或灰度），可从任意线程调用
+    // 请求只持有 image 的引用，future 就绪前不能修改其像素；失败时结果的 classId 为 -1，
+    // 服务未启动或已停止时立即失败
+    std::future<RecognitionResult> submit(const cv::Mat& image);
+
+    // 获取统计信息
+    Stats stats() const;
+
+private:
+    // 一个识别请求，入队后由服务线程负责释放
+    struct Request {
+        cv::Mat image;
+        std::promise<RecognitionResult> promise;
+        std::chrono::steady_clock::time_point submitted;
+        Request* next;
+    };
+
+    // 服务线程函数
+    void serviceThread(std::promise<bool>* ready);
+
+    // 取出全部已提交的请求，按提交顺序追加到 (head, tail) 链表尾部，返回取出的个数
+    size_t takeRequests(Request*& head, Request*& tail);
+
+    // 睡眠直到 wake 返回true（timed 为true时最多到 deadline），睡眠期间提交请求会唤醒本线程
+    template <typename Predicate>
+    void sleepUntil(std::chrono::steady_clock::time_point deadline, bool timed, Predicate wake);
+
+    // 对链表头部最多 max_batch_ 个请求做一次推理，完成它们的 future，返回处理的个数
+    size_t runBatch(PythonWrapper& wrapper, Request*& head, Request*& tail);
+
+    // 以失败结果完成 inbox_ 中剩余的请求
+    void failRemaining();
+
+    std::string model_path_; // 模型路径
+    size_t max_batch_; // 单次推理的最大图像数
+    std::chrono::microseconds coalesce_; // 合并等待时间
+
+    std::thread thread_; // 服务线程
+    std::atomic<Request*> inbox_; // 无锁请求栈（多生产者 push，服务线程一次取走全部）
+    std::atomic<size_t> submitted_; // 栈中的请求数
+    std::atomic<bool> waiting_; // 服务线程是否在等待，生产者据此决定是否需要唤醒
+    std::atomic<bool> accepting_; // 服务线程是否接受新请求
+    std::atomic<bool> stop_; // 是否停止
+    std::mutex mutex_; // 只用于服务线程的睡眠和唤醒
+    std::condition_variable wake_cv_; // 唤醒服务线程
+
+    std::atomic<uint64_t> requests_; // 已完成的请求数
+    std::atomic<uint64_t> batches_; // 前向推理次数
+    std::atomic<uint64_t> failed_; // 失败的请求数
+    std::atomic<uint64_t> max_batch_seen_; // 单次推理的最大批次
+};
+
+#endif // RECOGNITION_SERVICE_H
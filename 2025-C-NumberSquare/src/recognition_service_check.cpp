@@ -0,0 +1,201 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <future>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+#include "recognition_service.h"
+
+// 校验并压测 RecognitionService
+// 先逐张识别一组合成图像（BGR、灰度和非连续的 ROI）得到基准结果，然后多个线程以随机间隔并发提交，
+// 检查每个请求都成功且类别与基准一致；再检查空图像、启动前和停止后的提交立即失败，
+// 以及停止时已提交的请求全部完成。任一检查失败时返回非零
+//
+// 用法: recognition_service_check <模型路径> [--threads N] [--requests N] [--batch N] [--coalesce us]
+
+namespace {
+
+// 等待单个结果的最长时间，超时视为请求丢失
+const std::chrono::seconds kResultTimeout(30);
+
+// 生成合成图像：随机背景上的白色方块和一个数字，前半为 BGR，后半为灰度，最后几张为大图中的 ROI
+std::vector<cv::Mat> makeImages(int count) {
+    std::vector<cv::Mat> images;
+    cv::RNG rng(20250);
+    for (int i = 0; i < count; ++i) {
+        cv::Mat image(160, 160, CV_8UC3);
+        rng.fill(image, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(128));
+        cv::rectangle(image, cv::Rect(30, 30, 100, 100), cv::Scalar::all(255), cv::FILLED);
+        cv::putText(image, std::to_string(i % 10), cv::Point(55, 110), cv::FONT_HERSHEY_SIMPLEX, 2.5,
+                    cv::Scalar::all(0), 6);
+
+        if (i >= count - 2) {
+            // 非连续的 ROI，行步长大于行宽
+            cv::Mat canvas(320, 320, CV_8UC3, cv::Scalar::all(64));
+            cv::Mat roi = canvas(cv::Rect(80, 80, 160, 160));
+            image.copyTo(roi);
+            images.push_back(roi);
+        } else if (i >= count / 2) {
+            cv::Mat gray;
+            cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+            images.push_back(gray);
+        } else {
+            images.push_back(image);
+        }
+    }
+    return images;
+}
+
+// 等待结果，超时时返回失败结果
+RecognitionResult waitResult(std::future<RecognitionResult>& future) {
+    if (future.wait_for(kResultTimeout) != std::future_status::ready) {
+        RecognitionResult result;
+        result.classId = -1;
+        result.confidence = 0.0f;
+        return result;
+    }
+    return future.get();
+}
+
+// 输出一项检查的结果
+bool report(const std::string& name, bool pass) {
+    std::cout << name << ": " << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <model.pth> [--threads N] [--requests N] [--batch N] [--coalesce us]"
+                  << std::endl;
+        return 1;
+    }
+
+    // 解析命令行参数
+    int threads = 8;
+    int requests = 200;
+    size_t maxBatch = 16;
+    int64_t coalesceMicros = 2000;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--requests" && i + 1 < argc) {
+            requests = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--batch" && i + 1 < argc) {
+            maxBatch = static_cast<size_t>(std::max(1, atoi(argv[++i])));
+        } else if (arg == "--coalesce" && i + 1 < argc) {
+            coalesceMicros = atoll(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<cv::Mat> images = makeImages(12);
+    RecognitionService service(argv[1], maxBatch, coalesceMicros);
+    bool pass = true;
+
+    // 启动前提交立即失败
+    std::future<RecognitionResult> early = service.submit(images[0]);
+    pass &= report("submit before start",
+                   early.wait_for(std::chrono::seconds(0)) == std::future_status::ready && early.get().classId < 0);
+
+    if (!service.start()) {
+        std::cerr << "Failed to start recognition service" << std::endl;
+        return 1;
+    }
+
+    // 基准：逐张提交并等待，每次推理只有一张图像
+    std::vector<int> expected(images.size());
+    bool baseline_ok = true;
+    for (size_t i = 0; i < images.size(); ++i) {
+        std::future<RecognitionResult> future = service.submit(images[i]);
+        expected[i] = waitResult(future).classId;
+        baseline_ok &= expected[i] >= 0;
+    }
+    if (!report("sequential baseline", baseline_ok)) {
+        service.stop();
+        return 1;
+    }
+
+    // 并发压测：每个线程以随机间隔提交，部分请求立即等待，其余攒到最后一起等待
+    std::vector<int> mismatches(threads, 0);
+    std::vector<int> failures(threads, 0);
+    std::vector<std::thread> workers;
+    std::chrono::steady_clock::time_point stress_start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.push_back(std::thread([&, t]() {
+            std::mt19937 rng(static_cast<uint32_t>(t) * 7919u + 1u);
+            std::vector<std::pair<size_t, std::future<RecognitionResult>>> pending;
+            for (int k = 0; k < requests; ++k) {
+                size_t index = rng() % images.size();
+                pending.push_back(std::make_pair(index, service.submit(images[index])));
+                if (rng() % 4 == 0) {
+                    RecognitionResult result = waitResult(pending.back().second);
+                    failures[t] += result.classId < 0 ? 1 : 0;
+                    mismatches[t] += result.classId >= 0 && result.classId != expected[index] ? 1 : 0;
+                    pending.pop_back();
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(rng() % 500));
+            }
+            for (size_t k = 0; k < pending.size(); ++k) {
+                RecognitionResult result = waitResult(pending[k].second);
+                failures[t] += result.classId < 0 ? 1 : 0;
+                mismatches[t] += result.classId >= 0 && result.classId != expected[pending[k].first] ? 1 : 0;
+            }
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); ++t) {
+        workers[t].join();
+    }
+    double stress_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stress_start).count();
+    int total_failures = 0;
+    int total_mismatches = 0;
+    for (int t = 0; t < threads; ++t) {
+        total_failures += failures[t];
+        total_mismatches += mismatches[t];
+    }
+    std::cout << "stress: " << threads * requests << " requests in " << stress_ms << " ms, failed=" << total_failures
+              << " mismatched=" << total_mismatches << std::endl;
+    pass &= report("concurrent stress", total_failures == 0 && total_mismatches == 0);
+
+    // 空图像立即失败，不进入批次
+    std::future<RecognitionResult> empty = service.submit(cv::Mat());
+    pass &= report("empty image",
+                   empty.wait_for(std::chrono::seconds(0)) == std::future_status::ready && empty.get().classId < 0);
+
+    // 停止时已提交的请求全部完成
+    std::vector<std::future<RecognitionResult>> burst;
+    for (size_t k = 0; k < maxBatch * 4; ++k) {
+        burst.push_back(service.submit(images[k % images.size()]));
+    }
+    service.stop();
+    bool drained = true;
+    for (size_t k = 0; k < burst.size(); ++k) {
+        drained &= burst[k].wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+                   burst[k].get().classId == expected[k % images.size()];
+    }
+    pass &= report("drain on stop", drained);
+
+    // 停止后提交立即失败
+    std::future<RecognitionResult> late = service.submit(images[0]);
+    pass &= report("submit after stop",
+                   late.wait_for(std::chrono::seconds(0)) == std::future_status::ready && late.get().classId < 0);
+
+    RecognitionService::Stats stats = service.stats();
+    std::cout << "stats: requests=" << stats.requests << " batches=" << stats.batches << " failed=" << stats.failed
+              << " max_batch=" << stats.max_batch << std::endl;
+    if (stats.max_batch <= 1 && maxBatch > 1) {
+        std::cout << "warning: requests were never coalesced into a batch" << std::endl;
+    }
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,334 @@
+#include "square_net.h"
+#include "gemm.h"
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+
+const int kConv1Out = 32;
+const int kConv2Out = 64;
+const int kConv3Out = 128;
+const int kFeatureSize = kConv3Out * 16 * 16; // 全连接层输入维度
+const int kHiddenSize = 1024; // 第一个全连接层输出维度
+
+// 查找指定名称、类型和形状的张量
+const void* tensorData(const WeightsFile& weights, const std::string& name, WeightsFile::DType dtype,
+                       const std::vector<uint32_t>& shape) {
+    const WeightsFile::Tensor* tensor = weights.find(name);
+    if (!tensor) {
+        std::cerr << "Missing tensor in weights file: " << name << std::endl;
+        return nullptr;
+    }
+    if (tensor->dtype != dtype || tensor->shape != shape) {
+        std::cerr << "Unexpected type or shape for tensor: " << name << std::endl;
+        return nullptr;
+    }
+    return tensor->data;
+}
+
+// 取出 float32 张量
+bool takeTensor(const WeightsFile& weights, const std::string& name, const std::vector<uint32_t>& shape,
+                const float*& out) {
+    out = static_cast<const float*>(tensorData(weights, name, WeightsFile::kFloat32, shape));
+    return out != nullptr;
+}
+
+// 取出 int8 张量
+bool takeTensor(const WeightsFile& weights, const std::string& name, const std::vector<uint32_t>& shape,
+                const int8_t*& out) {
+    out = static_cast<const int8_t*>(tensorData(weights, name, WeightsFile::kInt8, shape));
+    return out != nullptr;
+}
+
+// 取出标量
+bool takeScalar(const WeightsFile& weights, const std::string& name, float& out) {
+    const float* data = nullptr;
+    if (!takeTensor(weights, name, {1}, data)) {
+        return false;
+    }
+    out = data[0];
+    if (!(out > 0.0f)) {
+        std::cerr << "Invalid scale in weights file: " << name << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 3x3、padding=1、stride=1 卷积的 im2col 展开
+// 输出矩阵为 (channels*9) x (size*size)，第 (c*9 + ky*3 + kx) 行是输入通道 c 按偏移 (ky-1, kx-1) 平移后的图像
+void im2col3x3(const float* input, int channels, int size, float* columns, WorkerPool& pool) {
+    size_t plane = static_cast<size_t>(size) * size;
+    pool.parallelFor(static_cast<size_t>(channels) * 9, [&](size_t begin, size_t end) {
+        for (size_t row = begin; row < end; ++row) {
+            int c = static_cast<int>(row / 9);
+            int dy = static_cast<int>(row % 9) / 3 - 1;
+            int dx = static_cast<int>(row % 3) - 1;
+            const float* src = input + c * plane;
+            float* dst = columns + row * plane;
+            for (int y = 0; y < size; ++y) {
+                float* out = dst + static_cast<size_t>(y) * size;
+                int sy = y + dy;
+                if (sy < 0 || sy >= size) {
+                    memset(out, 0, sizeof(float) * size);
+                    continue;
+                }
+                // 行内平移一列，越界的一端补零
+                const float* in = src + static_cast<size_t>(sy) * size;
+                if (dx < 0) {
+                    out[0] = 0.0f;
+                    memcpy(out + 1, in, sizeof(float) * (size - 1));
+                } else if (dx > 0) {
+                    memcpy(out, in + 1, sizeof(float) * (size - 1));
+                    out[size - 1] = 0.0f;
+                } else {
+                    memcpy(out, in, sizeof(float) * size);
+                }
+            }
+        }
+    });
+}
+
+// 2x2、stride=2 最大池化
+void maxPool2x2(const float* input, int channels, int size, float* output, WorkerPool& pool) {
+    int half = size / 2;
+    pool.parallelFor(static_cast<size_t>(channels), [&](size_t begin, size_t end) {
+        for (size_t c = begin; c < end; ++c) {
+            const float* src = input + c * size * size;
+            float* dst = output + c * half * half;
+            for (int y = 0; y < half; ++y) {
+                const float* row0 = src + static_cast<size_t>(2 * y) * size;
+                const float* row1 = row0 + size;
+                for (int x = 0; x < half; ++x) {
+                    dst[y * half + x] =
+                        std::max(std::max(row0[2 * x], row0[2 * x + 1]), std::max(row1[2 * x], row1[2 * x + 1]));
+                }
+            }
+        }
+    });
+}
+
+} // namespace
+
+const int SquareNet::kInputSize;
+const int SquareNet::kInputChannels;
+const int SquareNet::kNumClasses;
+
+SquareNet::SquareNet(size_t threads)
+    : pool_(threads),
+      loaded_(false),
+      quantized_(false),
+      conv1_weight_(nullptr),
+      conv1_bias_(nullptr),
+      conv2_weight_(nullptr),
+      conv2_bias_(nullptr),
+      conv3_weight_(nullptr),
+      conv3_bias_(nullptr),
+      fc1_weight_(nullptr),
+      fc1_bias_(nullptr),
+      fc2_weight_(nullptr),
+      fc2_bias_(nullptr),
+      fc1_qweight_(nullptr),
+      fc2_qweight_(nullptr),
+      fc1_weight_scale_(nullptr),
+      fc2_weight_scale_(nullptr),
+      fc1_input_scale_(0.0f),
+      fc2_input_scale_(0.0f) {
+}
+
+bool SquareNet::loadWeights(const std::string& path) {
+    loaded_ = false;
+    if (!weights_.open(path)) {
+        return false;
+    }
+
+    // 形状与 PyTorch state_dict 一致
+    std::vector<uint32_t> conv1_shape = {kConv1Out, kInputChannels, 3, 3};
+    std::vector<uint32_t> conv2_shape = {kConv2Out, kConv1Out, 3, 3};
+    std::vector<uint32_t> conv3_shape = {kConv3Out, kConv2Out, 3, 3};
+    std::vector<uint32_t> fc1_shape = {kHiddenSize, kFeatureSize};
+    std::vector<uint32_t> fc2_shape = {kNumClasses, kHiddenSize};
+    bool ok = takeTensor(weights_, "conv1.weight", conv1_shape, conv1_weight_) &&
+              takeTensor(weights_, "conv1.bias", {kConv1Out}, conv1_bias_) &&
+              takeTensor(weights_, "conv2.weight", conv2_shape, conv2_weight_) &&
+              takeTensor(weights_, "conv2.bias", {kConv2Out}, conv2_bias_) &&
+              takeTensor(weights_, "conv3.weight", conv3_shape, conv3_weight_) &&
+              takeTensor(weights_, "conv3.bias", {kConv3Out}, conv3_bias_) &&
+              takeTensor(weights_, "fc1.bias", {kHiddenSize}, fc1_bias_) &&
+              takeTensor(weights_, "fc2.bias", {kNumClasses}, fc2_bias_);
+    if (!ok) {
+        return false;
+    }
+
+    // quantize.py 导出的文件中全连接层权重为 int8，另带每个输出通道的权重缩放和校准得到的输入缩放
+    const WeightsFile::Tensor* fc1 = weights_.find("fc1.weight");
+    quantized_ = fc1 && fc1->dtype == WeightsFile::kInt8;
+    if (quantized_) {
+        ok = takeTensor(weights_, "fc1.weight", fc1_shape, fc1_qweight_) &&
+             takeTensor(weights_, "fc1.weight_scale", {kHiddenSize}, fc1_weight_scale_) &&
+             takeScalar(weights_, "fc1.input_scale", fc1_input_scale_) &&
+             takeTensor(weights_, "fc2.weight", fc2_shape, fc2_qweight_) &&
+             takeTensor(weights_, "fc2.weight_scale", {kNumClasses}, fc2_weight_scale_) &&
+             takeScalar(weights_, "fc2.input_scale", fc2_input_scale_);
+        fc1_weight_ = nullptr;
+        fc2_weight_ = nullptr;
+    } else {
+        ok = takeTensor(weights_, "fc1.weight", fc1_shape, fc1_weight_) &&
+             takeTensor(weights_, "fc2.weight", fc2_shape, fc2_weight_);
+        fc1_qweight_ = nullptr;
+        fc2_qweight_ = nullptr;
+    }
+    if (!ok) {
+        return false;
+    }
+
+    // 预先分配单张图像所需的中间缓冲区
+    columns_.resize(std::max(std::max(kInputChannels * 9 * kInputSize * kInputSize, kConv1Out * 9 * 64 * 64),
+                             kConv2Out * 9 * 32 * 32));
+    conv_out_.resize(kConv1Out * kInputSize * kInputSize);
+    pooled1_.resize(kConv1Out * 64 * 64);
+    pooled2_.resize(kConv2Out * 32 * 32);
+
+    loaded_ = true;
+    return true;
+}
+
+bool SquareNet::isLoaded() const {
+    return loaded_;
+}
+
+bool SquareNet::isQuantized() const {
+    return quantized_;
+}
+
+size_t SquareNet::weightBytes() const {
+    return weights_.totalBytes();
+}
+
+bool SquareNet::isMapped() const {
+    return weights_.isMapped();
+}
+
+void SquareNet::convReluPool(const float* input, int inChannels, int size, const float* weight, const float* bias,
+                             int outChannels, float* output) {
+    // 卷积：权重 (outChannels) x (inChannels*9) 乘以展开矩阵 (inChannels*9) x (size*size)
+    int plane = size * size;
+    int depth = inChannels * 9;
+    im2col3x3(input, inChannels, size, columns_.data(), pool_);
+    sgemm(outChannels, plane, depth, weight, depth, columns_.data(), plane, conv_out_.data(), plane, bias, true,
+          pool_);
+    maxPool2x2(conv_out_.data(), outChannels, size, output, pool_);
+}
+
+bool SquareNet::forward(const float* input, int batch, float* logits) {
+    if (!loaded_) {
+        std::cerr << "SquareNet weights not loaded" << std::endl;
+        return false;
+    }
+    if (batch <= 0) {
+        return true;
+    }
+
+    // 卷积部分逐张计算，每层内部并行；结果直接写入全连接层的输入矩阵
+    features_.resize(static_cast<size_t>(batch) * kFeatureSize);
+    hidden_.resize(static_cast<size_t>(batch) * kHiddenSize);
+    size_t input_plane = static_cast<size_t>(kInputChannels) * kInputSize * kInputSize;
+    for (int b = 0; b < batch; ++b) {
+        convReluPool(input + b * input_plane, kInputChannels, kInputSize, conv1_weight_, conv1_bias_, kConv1Out,
+                     pooled1_.data());
+        convReluPool(pooled1_.data(), kConv1Out, 64, conv2_weight_, conv2_bias_, kConv2Out, pooled2_.data());
+        convReluPool(pooled2_.data(), kConv2Out, 32, conv3_weight_, conv3_bias_, kConv3Out,
+                     features_.data() + static_cast<size_t>(b) * kFeatureSize);
+    }
+
+    // 展平顺序 (C, H, W) 与 PyTorch 的 view(-1, 128*16*16) 一致
+    if (quantized_) {
+        denseForwardInt8(features_.data(), batch, kFeatureSize, fc1_input_scale_, fc1_qweight_, fc1_weight_scale_,
+                         fc1_bias_, kHiddenSize, hidden_.data(), true, quantized_input_, pool_);
+        denseForwardInt8(hidden_.data(), batch, kHiddenSize, fc2_input_scale_, fc2_qweight_, fc2_weight_scale_,
+                         fc2_bias_, kNumClasses, logits, false, quantized_input_, pool_);
+        return true;
+    }
+    denseForward(features_.data(), batch, kFeatureSize, fc1_weight_, fc1_bias_, kHiddenSize, hidden_.data(), true,
+                 pool_);
+    denseForward(hidden_.data(), batch, kHiddenSize, fc2_weight_, fc2_bias_, kNumClasses, logits, false, pool_);
+    return true;
+}
+
+bool SquareNet::preprocess(const cv::Mat& image, float* input) {
+    if (image.empty() || image.depth() != CV_8U || (image.channels() != 1 && image.channels() != 3)) {
+        std::cerr << "Expected a non-empty 8-bit BGR or grayscale image" << std::endl;
+        return false;
+    }
+
+    // 已是输入尺寸（如透视矫正得到的裁剪图）时不再缩放；灰度图直接复制到三个通道
+    cv::Mat resized = image;
+    if (image.cols != kInputSize || image.rows != kInputSize) {
+        cv::resize(image, resized, cv::Size(kInputSize, kInputSize));
+    }
+    int channels = resized.channels();
+    int red = channels == 3 ? 2 : 0;
+    int green = channels == 3 ? 1 : 0;
+
+    // BGR 交错 -> RGB 平面，并归一化到 0~1
+    size_t plane = static_cast<size_t>(kInputSize) * kInputSize;
+    for (int y = 0; y < kInputSize; ++y) {
+        const uint8_t* row = resized.ptr<uint8_t>(y);
+        for (int x = 0; x < kInputSize; ++x) {
+            size_t offset = static_cast<size_t>(y) * kInputSize + x;
+            const uint8_t* pixel = row + x * channels;
+            input[offset] = pixel[red] / 255.0f;
+            input[plane + offset] = pixel[green] / 255.0f;
+            input[2 * plane + offset] = pixel[0] / 255.0f;
+        }
+    }
+    return true;
+}
+
+bool SquareNet::classify(const std::vector<cv::Mat>& images, std::vector<RecognitionResult>& results) {
+    results.clear();
+    if (images.empty()) {
+        return true;
+    }
+
+    size_t input_size = static_cast<size_t>(kInputChannels) * kInputSize * kInputSize;
+    inputs_.resize(images.size() * input_size);
+    std::atomic<bool> ok(true);
+    pool_.parallelFor(images.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (!preprocess(images[i], inputs_.data() + i * input_size)) {
+                ok.store(false);
+            }
+        }
+    });
+    if (!ok.load()) {
+        return false;
+    }
+
+    logits_.resize(images.size() * kNumClasses);
+    if (!forward(inputs_.data(), static_cast<int>(images.size()), logits_.data())) {
+        return false;
+    }
+
+    // softmax 取最大类别的概率作为置信度
+    for (size_t i = 0; i < images.size(); ++i) {
+        const float* row = logits_.data() + i * kNumClasses;
+        int best = static_cast<int>(std::max_element(row, row + kNumClasses) - row);
+        float sum = 0.0f;
+        for (int c = 0; c < kNumClasses; ++c) {
+            sum += std::exp(row[c] - row[best]);
+        }
+        RecognitionResult result;
+        result.classId = best;
+        result.confidence = 1.0f / sum;
+        results.push_back(result);
+    }
+    return true;
+}
+
+const char* SquareNet::kernelName() const {
+    return quantized_ ? int8KernelName() : gemmKernelName();
+}
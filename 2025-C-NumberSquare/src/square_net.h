@@ -0,0 +1,88 @@
+#ifndef SQUARE_NET_H
+#define SQUARE_NET_H
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+#include "recognition_result.h"
+#include "worker_pool.h"
+#include "weights_file.h"
+
+// SquareNet 的纯 C++ 前向推理，结构与 src/python/infer.py 中的 PyTorch 模型一致：
+//   conv3x3(3->32)+ReLU+maxpool2 -> conv3x3(32->64)+ReLU+maxpool2 -> conv3x3(64->128)+ReLU+maxpool2
+//   -> FC(128*16*16 -> 1024)+ReLU -> FC(1024 -> 10)
+// 卷积用 im2col + 分块并行 GEMM 计算，全连接层按输出维度并行；
+// 权重由 src/python/export_weights.py 从 best_epoch_weights.pth 导出，以只读 mmap 方式直接使用，不拷贝；
+// 加载 src/python/quantize.py 导出的文件时，全连接层使用 int8 权重和 int32 累加（卷积层仍为 float）
+// 中间缓冲区在对象内复用，forward/classify 不可从多个线程同时调用
+class SquareNet {
+public:
+    static const int kInputSize = 128; // 输入边长
+    static const int kInputChannels = 3; // 输入通道数（RGB）
+    static const int kNumClasses = 10; // 类别数
+
+    // threads 为推理线程数（含调用线程），0 表示使用全部硬件线程
+    explicit SquareNet(size_t threads = 0);
+
+    // 加载导出的权重文件
+    bool loadWeights(const std::string& path);
+
+    // 是否已加载权重
+    bool isLoaded() const;
+
+    // 是否使用 int8 量化的全连接层
+    bool isQuantized() const;
+
+    // 权重的字节数
+    size_t weightBytes() const;
+
+    // 权重是否为 mmap 映射（版本 3 文件），否则已读入进程内存
+    bool isMapped() const;
+
+    // 前向推理
+    // input 为 batch 个 (3, 128, 128) 的 RGB 图像，取值 0~1；logits 输出 batch x 10
+    bool forward(const float* input, int batch, float* logits);
+
+    // 预处理：与 infer.py 相同，缩放到 128x128、BGR 转 RGB、除以 255，输出 (3, 128, 128)
+    // 输入已是 128x128 时不缩放也不分配内存，可从多个线程同时调用
+    static bool preprocess(const cv::Mat& image, float* input);
+
+    // 预处理并批量识别，results 与 images 一一对应；各图像的预处理和整批前向推理都在线程池上并行
+    bool classify(const std::vector<cv::Mat>& images, std::vector<RecognitionResult>& results);
+
+    // 当前使用的计算内核名称（量化模式下为全连接层的 int8 内核）
+    const char* kernelName() const;
+
+private:
+    // 一层卷积 + ReLU + 2x2 最大池化
+    void convReluPool(const float* input, int inChannels, int size, const float* weight, const float* bias,
+                      int outChannels, float* output);
+
+    WorkerPool pool_; // 推理线程池
+    bool loaded_; // 是否已加载权重
+    bool quantized_; // 全连接层是否为 int8
+
+    // 各层参数指向 weights_ 中的数据
+    WeightsFile weights_; // 权重文件
+    const float* conv1_weight_; const float* conv1_bias_; // (32, 3, 3, 3)
+    const float* conv2_weight_; const float* conv2_bias_; // (64, 32, 3, 3)
+    const float* conv3_weight_; const float* conv3_bias_; // (128, 64, 3, 3)
+    const float* fc1_weight_; const float* fc1_bias_; // (1024, 32768)
+    const float* fc2_weight_; const float* fc2_bias_; // (10, 1024)
+
+    // int8 全连接层：权重 (outDim, K)，每个输出通道一个权重缩放，输入缩放由校准得到
+    const int8_t* fc1_qweight_; const int8_t* fc2_qweight_;
+    const float* fc1_weight_scale_; const float* fc2_weight_scale_;
+    float fc1_input_scale_, fc2_input_scale_;
+
+    std::vector<float> columns_; // im2col 展开结果
+    std::vector<float> conv_out_; // 卷积输出（池化前）
+    std::vector<float> pooled1_, pooled2_; // 前两层池化输出
+    std::vector<float> features_; // 第三层池化输出，即全连接层输入（batch x 32768）
+    std::vector<float> hidden_; // 第一个全连接层输出（batch x 1024）
+    std::vector<uint8_t> quantized_input_; // int8 全连接层的量化输入
+    std::vector<float> inputs_; // classify 的预处理结果
+    std::vector<float> logits_; // classify 的推理结果
+};
+
+#endif // SQUARE_NET_H
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "square_net.h"
+
+// 校验并测量 C++ SquareNet 推理
+// 读取 export_weights.py --reference 导出的输入和 PyTorch 输出，比较 logits 的误差和预测类别，
+// 然后分别测量批次 1 和整个批次的推理耗时；误差超出容差时返回非零
+// 同时报告冷启动耗时：加载权重和第一次推理（mmap 的权重在第一次推理时才换入）
+// 权重为 quantize.py 导出的 int8 文件时，默认容差放宽到 5e-2
+//
+// 用法: square_net_check <权重文件> <参考数据> [--threads N] [--runs N] [--tolerance X]
+
+namespace {
+
+// 读取参考数据："SQNR" | uint32 批次 | uint32 类别数 | float32 输入 | float32 输出
+bool readReference(const std::string& path, int& batch, std::vector<float>& inputs, std::vector<float>& outputs) {
+    std::ifstream file(path.c_str(), std::ios::binary);
+    char magic[4];
+    uint32_t header[2] = {0, 0};
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!file || memcmp(magic, "SQNR", 4) != 0 || header[0] == 0 || header[1] != SquareNet::kNumClasses) {
+        std::cerr << "Invalid reference file: " << path << std::endl;
+        return false;
+    }
+
+    batch = static_cast<int>(header[0]);
+    inputs.resize(static_cast<size_t>(batch) * SquareNet::kInputChannels * SquareNet::kInputSize * SquareNet::kInputSize);
+    outputs.resize(static_cast<size_t>(batch) * SquareNet::kNumClasses);
+    file.read(reinterpret_cast<char*>(inputs.data()), static_cast<std::streamsize>(inputs.size() * sizeof(float)));
+    file.read(reinterpret_cast<char*>(outputs.data()), static_cast<std::streamsize>(outputs.size() * sizeof(float)));
+    if (!file) {
+        std::cerr << "Truncated reference file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 多次推理取中位数耗时（毫秒）
+double medianMillis(SquareNet& net, const float* inputs, int batch, float* logits, int runs) {
+    std::vector<double> samples;
+    for (int i = 0; i < runs; ++i) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        net.forward(inputs, batch, logits);
+        samples.push_back(
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <weights.bin> <reference.bin> [--threads N] [--runs N] [--tolerance X]"
+                  << std::endl;
+        return 1;
+    }
+
+    // 解析命令行参数
+    size_t threads = 0;
+    int runs = 10;
+    double tolerance = -1;
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<size_t>(atoi(argv[++i]));
+        } else if (arg == "--runs" && i + 1 < argc) {
+            runs = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else {
+            std::cerr << "Unknown argument: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    int batch = 0;
+    std::vector<float> inputs, expected;
+    if (!readReference(argv[2], batch, inputs, expected)) {
+        return 1;
+    }
+
+    // 冷启动：加载权重到第一次推理完成
+    std::vector<float> logits(expected.size());
+    std::chrono::steady_clock::time_point load_start = std::chrono::steady_clock::now();
+    SquareNet net(threads);
+    if (!net.loadWeights(argv[1])) {
+        return 1;
+    }
+    std::chrono::steady_clock::time_point load_end = std::chrono::steady_clock::now();
+    net.forward(inputs.data(), 1, logits.data());
+    std::chrono::steady_clock::time_point first_end = std::chrono::steady_clock::now();
+    std::cout << "startup: load " << std::chrono::duration<double, std::milli>(load_end - load_start).count()
+              << " ms, first inference " << std::chrono::duration<double, std::milli>(first_end - load_end).count()
+              << " ms (" << (net.isMapped() ? "mmap" : "read") << ")" << std::endl;
+
+    if (tolerance < 0) {
+        tolerance = net.isQuantized() ? 5e-2 : 1e-3;
+    }
+
+    // 与 PyTorch 输出比较：相对最大输出幅值的误差
+    net.forward(inputs.data(), batch, logits.data());
+    double max_diff = 0;
+    double max_abs = 0;
+    int argmax_mismatch = 0;
+    for (int b = 0; b < batch; ++b) {
+        const float* got = logits.data() + b * SquareNet::kNumClasses;
+        const float* ref = expected.data() + b * SquareNet::kNumClasses;
+        for (int c = 0; c < SquareNet::kNumClasses; ++c) {
+            max_diff = std::max(max_diff, static_cast<double>(std::fabs(got[c] - ref[c])));
+            max_abs = std::max(max_abs, static_cast<double>(std::fabs(ref[c])));
+        }
+        if (std::max_element(got, got + SquareNet::kNumClasses) - got !=
+            std::max_element(ref, ref + SquareNet::kNumClasses) - ref) {
+            ++argmax_mismatch;
+        }
+    }
+    bool pass = max_diff <= tolerance * std::max(1.0, max_abs) && argmax_mismatch == 0;
+    std::cout << "precision=" << (net.isQuantized() ? "int8" : "float32") << " weights="
+              << net.weightBytes() / (1024.0 * 1024.0) << " MiB" << std::endl;
+    std::cout << "kernel=" << net.kernelName() << " batch=" << batch << " max_abs_diff=" << max_diff
+              << " max_abs_logit=" << max_abs << " argmax_mismatch=" << argmax_mismatch << " -> "
+              << (pass ? "PASS" : "FAIL") << std::endl;
+
+    // 推理耗时
+    double single_ms = medianMillis(net, inputs.data(), 1, logits.data(), runs);
+    double batch_ms = medianMillis(net, inputs.data(), batch, logits.data(), runs);
+    std::cout << "forward batch=1: " << single_ms << " ms, batch=" << batch << ": " << batch_ms << " ms ("
+              << batch_ms / batch << " ms/image)" << std::endl;
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+#include "weights_file.h"
+#include <iostream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace {
+
+const char kMagic[4] = {'S', 'Q', 'N', 'W'}; // 权重文件标识
+const uint32_t kVersionMapped = 3; // 版本 3：对齐的平坦布局，可直接 mmap
+
+// 版本 3 布局（全部为小端）：
+//   文件头 64 字节: "SQNW" | uint32 版本 | uint32 张量数 | uint32 对齐 | uint64 文件长度 | 保留
+//   张量表: 每项 96 字节: char 名称[56]（以 0 结尾）| uint32 数据类型 | uint32 维数 | uint32 形状[4]
+//           | uint64 数据偏移（对齐）| uint64 数据字节数
+//   张量数据: 从各自的偏移开始
+const size_t kHeaderSize = 64;
+const size_t kEntrySize = 96;
+const size_t kNameSize = 56;
+const uint32_t kMaxDims = 4;
+
+size_t dtypeSize(uint32_t dtype) {
+    return dtype == WeightsFile::kInt8 ? 1 : 4;
+}
+
+bool validDtype(uint32_t dtype) {
+    return dtype == WeightsFile::kFloat32 || dtype == WeightsFile::kInt8;
+}
+
+} // namespace
+
+WeightsFile::WeightsFile() : mapping_(nullptr), mapping_size_(0), version_(0) {
+    // 构造函数初始化
+}
+
+WeightsFile::~WeightsFile() {
+    close();
+}
+
+bool WeightsFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::cerr << "Failed to open weights file: " << path << std::endl;
+        return false;
+    }
+
+    char header[8];
+    uint32_t version = 0;
+    if (pread(fd, header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+        memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+        std::cerr << "Invalid weights file header: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+    memcpy(&version, header + 4, sizeof(version));
+
+    bool ok = false;
+    if (version == kVersionMapped) {
+        ok = openMapped(fd, path);
+        ::close(fd); // 映射建立后不再需要文件描述符
+    } else {
+        std::cerr << "Unsupported weights file version " << version << " (re-export with export_weights.py): " << path
+                  << std::endl;
+        ::close(fd);
+    }
+
+    if (!ok) {
+        close();
+        return false;
+    }
+    version_ = version;
+    return true;
+}
+
+void WeightsFile::close() {
+    tensors_.clear();
+    if (mapping_) {
+        munmap(mapping_, mapping_size_);
+        mapping_ = nullptr;
+        mapping_size_ = 0;
+    }
+    version_ = 0;
+}
+
+const WeightsFile::Tensor* WeightsFile::find(const std::string& name) const {
+    std::map<std::string, Tensor>::const_iterator it = tensors_.find(name);
+    return it == tensors_.end() ? nullptr : &it->second;
+}
+
+bool WeightsFile::isMapped() const {
+    return mapping_ != nullptr;
+}
+
+uint32_t WeightsFile::version() const {
+    return version_;
+}
+
+size_t WeightsFile::totalBytes() const {
+    size_t bytes = 0;
+    for (std::map<std::string, Tensor>::const_iterator it = tensors_.begin(); it != tensors_.end(); ++it) {
+        bytes += it->second.bytes;
+    }
+    return bytes;
+}
+
+bool WeightsFile::openMapped(int fd, const std::string& path) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < kHeaderSize) {
+        std::cerr << "Truncated weights file: " << path << std::endl;
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+
+    // 只读共享映射：不预读，页面在推理首次访问时换入，多个进程共享页缓存中的同一份数据
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Failed to mmap weights file: " << path << std::endl;
+        return false;
+    }
+    mapping_ = mapping;
+    mapping_size_ = size;
+    const uint8_t* base = static_cast<const uint8_t*>(mapping);
+
+    uint32_t count = 0;
+    uint32_t alignment = 0;
+    uint64_t file_size = 0;
+    memcpy(&count, base + 8, sizeof(count));
+    memcpy(&alignment, base + 12, sizeof(alignment));
+    memcpy(&file_size, base + 16, sizeof(file_size));
+    if (file_size != size || alignment < 4 || (alignment & (alignment - 1)) != 0 ||
+        count > (size - kHeaderSize) / kEntrySize) {
+        std::cerr << "Invalid weights file header: " << path << std::endl;
+        return false;
+    }
+
+    for (uint32_t t = 0; t < count; ++t) {
+        const uint8_t* entry = base + kHeaderSize + t * kEntrySize;
+        const char* name = reinterpret_cast<const char*>(entry);
+        size_t name_length = strnlen(name, kNameSize);
+        uint32_t dtype = 0;
+        uint32_t ndim = 0;
+        uint32_t dims[kMaxDims];
+        uint64_t offset = 0;
+        uint64_t bytes = 0;
+        memcpy(&dtype, entry + kNameSize, sizeof(dtype));
+        memcpy(&ndim, entry + kNameSize + 4, sizeof(ndim));
+        memcpy(dims, entry + kNameSize + 8, sizeof(dims));
+        memcpy(&offset, entry + kNameSize + 24, sizeof(offset));
+        memcpy(&bytes, entry + kNameSize + 32, sizeof(bytes));
+
+        // 校验张量表，保证张量数据落在映射范围内
+        if (name_length == 0 || name_length == kNameSize || !validDtype(dtype) || ndim > kMaxDims ||
+            offset % alignment != 0 || offset > size || bytes > size - offset) {
+            std::cerr << "Invalid tensor entry " << t << " in weights file: " << path << std::endl;
+            return false;
+        }
+        Tensor& tensor = tensors_[std::string(name, name_length)];
+        tensor.dtype = static_cast<DType>(dtype);
+        tensor.shape.assign(dims, dims + ndim);
+        uint64_t elements = 1;
+        for (uint32_t d = 0; d < ndim && elements <= bytes; ++d) {
+            elements *= dims[d];
+        }
+        if (elements > bytes || elements * dtypeSize(dtype) != bytes) {
+            std::cerr << "Tensor size does not match its shape: " << std::string(name, name_length) << std::endl;
+            return false;
+        }
+        tensor.data = base + offset;
+        tensor.bytes = static_cast<size_t>(bytes);
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+#ifndef WEIGHTS_FILE_H
+#define WEIGHTS_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// SquareNet 权重文件（"SQNW"）
+// 版本 3（src/python/weights_file.py 写出）为对齐的平坦布局：固定长度的文件头和张量表，
+// 张量数据按 64 字节对齐；open 以只读方式 mmap 整个文件，张量直接指向映射内存，不拷贝，
+// 页面在首次访问时才从页缓存换入，同一台机器上的多个进程共享同一份物理页
+// 映射期间文件绝不能原地修改（截断会导致 SIGBUS），更新时由 write_weights 写出新文件后原子替换
+class WeightsFile {
+public:
+    // 张量数据类型
+    enum DType {
+        kFloat32 = 0,
+        kInt8 = 1
+    };
+
+    // 一个张量，data 在 WeightsFile 关闭前有效
+    struct Tensor {
+        DType dtype; // 数据类型
+        std::vector<uint32_t> shape; // 形状
+        const void* data; // 数据
+        size_t bytes; // 数据字节数
+    };
+
+    WeightsFile();
+    ~WeightsFile();
+    WeightsFile(const WeightsFile&) = delete;
+    WeightsFile& operator=(const WeightsFile&) = delete;
+
+    // 打开权重文件，之前打开的文件会被关闭
+    bool open(const std::string& path);
+
+    // 关闭文件，之前取得的张量数据失效
+    void close();
+
+    // 查找张量，不存在时返回 nullptr
+    const Tensor* find(const std::string& name) const;
+
+    // 是否已映射（即已打开文件）
+    bool isMapped() const;
+
+    // 文件版本
+    uint32_t version() const;
+
+    // 全部张量数据的字节数
+    size_t totalBytes() const;
+
+private:
+    // 映射并解析版本 3 文件
+    bool openMapped(int fd, const std::string& path);
+
+    std::map<std::string, Tensor> tensors_; // 按名称索引的张量
+    void* mapping_; // 版本 3 文件的映射地址
+    size_t mapping_size_; // 映射长度
+    uint32_t version_; // 文件版本
+};
+
+#endif // WEIGHTS_FILE_H
@@ -0,0 +1,88 @@
+#include "worker_pool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(size_t threads)
+    : task_(nullptr), count_(0), chunk_(1), next_(0), generation_(0), active_(0), stop_(false) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // 调用线程也参与计算，只需创建 threads - 1 个工作线程
+    for (size_t i = 1; i < threads; ++i) {
+        threads_.push_back(std::thread(&WorkerPool::workerThread, this));
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (size_t i = 0; i < threads_.size(); ++i) {
+        threads_[i].join();
+    }
+}
+
+void WorkerPool::parallelFor(size_t count, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) {
+        return;
+    }
+    // 单线程或只有一次迭代时直接执行
+    if (threads_.empty() || count == 1) {
+        fn(0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &fn;
+        count_ = count;
+        // 每个线程约分到4块，兼顾负载均衡和领取开销
+        chunk_ = std::max<size_t>(1, count / (threadCount() * 4));
+        next_.store(0);
+        active_ = threads_.size();
+        ++generation_;
+    }
+    start_cv_.notify_all();
+
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this]() { return active_ == 0; });
+    task_ = nullptr;
+}
+
+size_t WorkerPool::threadCount() const {
+    return threads_.size() + 1;
+}
+
+void WorkerPool::workerThread() {
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [this, seen]() { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+
+        runChunks();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--active_ == 0) {
+            done_cv_.notify_one();
+        }
+    }
+}
+
+void WorkerPool::runChunks() {
+    while (true) {
+        size_t begin = next_.fetch_add(chunk_);
+        if (begin >= count_) {
+            return;
+        }
+        (*task_)(begin, std::min(begin + chunk_, count_));
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+// 常驻工作线程池
+// 推理中每一层都要做一次并行循环，常驻线程避免了每层创建、销毁线程的开销；
+// 调用线程也参与计算，parallelFor 不可嵌套调用，也不可从多个线程同时调用
+class WorkerPool {
+public:
+    // threads 为参与计算的线程总数（含调用线程），0 表示使用全部硬件线程
+    explicit WorkerPool(size_t threads = 0);
+    ~WorkerPool();
+
+    // 把 [0, count) 切分为若干块并行执行 fn(begin, end)，全部完成后返回
+    void parallelFor(size_t count, const std::function<void(size_t, size_t)>& fn);
+
+    // 参与计算的线程总数（含调用线程）
+    size_t threadCount() const;
+
+private:
+    // 工作线程函数
+    void workerThread();
+
+    // 领取并执行剩余的块
+    void runChunks();
+
+    std::vector<std::thread> threads_; // 工作线程
+    std::mutex mutex_; // 保护任务状态
+    std::condition_variable start_cv_; // 有新任务或停止
+    std::condition_variable done_cv_; // 所有工作线程完成当前任务
+    const std::function<void(size_t, size_t)>* task_; // 当前任务
+    size_t count_; // 当前任务的总迭代数
+    size_t chunk_; // 每块的迭代数
+    std::atomic<size_t> next_; // 下一块的起始位置
+    uint64_t generation_; // 任务序号，工作线程据此判断是否有新任务
+    size_t active_; // 尚未完成当前任务的工作线程数
+    bool stop_; // 是否停止
+};
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,582 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <termios.h>
+#include "uart.h"
+#include "protocol.h"
+
+/**
+ * 串口链路基准测试
+ * 创建伪终端对，UART::init 打开从端，脚本化的对端线程操作主端；
+ * 对端按波特率限速发送以模拟真实链路，测量往返延迟、持续吞吐，
+ * 并检查二进制透明、分片、超时和突发数据下 send/receive 与帧解析的行为
+ * 任一检查失败时返回非零，可用于回归测试
+ *
+ * 用法: uart_link_bench [--baud <波特率，0为不限速>] [--rounds <往返次数>] [--seconds <吞吐测试秒数>]
+ */
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// 计算两个时间点之间的微秒数
+double elapsedMicros(Clock::time_point start, Clock::time_point end) {
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+// 伪终端主端，从端路径交给 UART::init
+class PtyPair {
+public:
+    PtyPair() : master_fd_(-1) {}
+
+    ~PtyPair() {
+        if (master_fd_ >= 0) {
+            ::close(master_fd_);
+        }
+    }
+
+    bool open() {
+        master_fd_ = posix_openpt(O_RDWR | O_NOCTTY);
+        if (master_fd_ < 0 || grantpt(master_fd_) < 0 || unlockpt(master_fd_) < 0) {
+            std::cerr << "Failed to create pty: " << strerror(errno) << std::endl;
+            return false;
+        }
+        // 主从两端共用一份 termios：这里不做任何设置，从端保持系统默认配置，
+        // 由 UART::init 自己完成原始模式设置，才能测出串口配置的问题
+        slave_path_ = ptsname(master_fd_);
+        return true;
+    }
+
+    int masterFd() const { return master_fd_; }
+    const std::string& slavePath() const { return slave_path_; }
+
+private:
+    int master_fd_;
+    std::string slave_path_;
+};
+
+// 按波特率限速：每字节 10 位（8N1）
+class Pacer {
+public:
+    explicit Pacer(uint32_t baud) : us_per_byte_(baud > 0 ? 10e6 / baud : 0), next_(Clock::now()) {}
+
+    // 等待到这些字节在线路上传输完毕的时刻
+    void wait(size_t bytes) {
+        if (us_per_byte_ <= 0) {
+            return;
+        }
+        Clock::time_point now = Clock::now();
+        if (next_ < now) {
+            next_ = now;
+        }
+        next_ += std::chrono::microseconds(static_cast<int64_t>(bytes * us_per_byte_));
+        std::this_thread::sleep_until(next_);
+    }
+
+    // 这些字节在线路上传输所需的时间
+    double wireMicros(size_t bytes) const { return bytes * us_per_byte_; }
+
+private:
+    double us_per_byte_;
+    Clock::time_point next_;
+};
+
+// 写入全部数据
+bool writeAll(int fd, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, data, len);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// 按波特率分块限速写入，模拟逐字节到达
+bool pacedWrite(int fd, const uint8_t* data, size_t len, Pacer& pacer) {
+    const size_t kChunk = 16;
+    for (size_t offset = 0; offset < len; offset += kChunk) {
+        size_t chunk = std::min(kChunk, len - offset);
+        pacer.wait(chunk);
+        if (!writeAll(fd, data + offset, chunk)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// 对端读取线程的一次读，超时返回0
+ssize_t readWithTimeout(int fd, uint8_t* buffer, size_t len, int timeout_ms) {
+    pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return 0;
+    }
+    return read(fd, buffer, len);
+}
+
+// 丢弃两个方向上残留的数据
+void drain(int master_fd, UART& uart) {
+    uint8_t buffer[4096];
+    tcflush(master_fd, TCIOFLUSH);
+    while (readWithTimeout(master_fd, buffer, sizeof(buffer), 10) > 0) {
+    }
+    while (uart.receive(buffer, sizeof(buffer), 10) > 0) {
+    }
+}
+
+// 生成一个测试用识别结果
+protocol::DetectionResult makeResult(uint32_t index) {
+    protocol::DetectionResult result;
+    for (int i = 0; i < 4; ++i) {
+        result.corners[i][0] = 100.0f + i * 40.0f + (index % 16) / 16.0f;
+        result.corners[i][1] = 80.0f + i * 30.0f;
+    }
+    result.edge_length = 40.0f;
+    result.class_id = static_cast<uint8_t>(index % 10);
+    result.timestamp_ms = index;
+    return result;
+}
+
+// 输出一行结果
+void report(const std::string& name, bool pass, const std::string& detail) {
+    std::cout << std::left << std::setw(20) << name << (pass ? "PASS  " : "FAIL  ") << detail << std::endl;
+}
+
+// 对端回显线程：收齐 PING 后按线路时间延迟并限速回复 PONG
+void echoPeer(int master_fd, uint32_t baud, std::atomic<bool>& stop) {
+    Pacer pacer(baud);
+    protocol::FrameEncoder encoder;
+    protocol::FrameParser parser([&](const protocol::Frame& frame) {
+        if (frame.type != protocol::MSG_PING) {
+            return;
+        }
+        // 请求在真实线路上需要这么久才能收齐（COBS 开销和结尾按2字节估算）
+        size_t request_size = protocol::kHeaderSize + frame.length + protocol::kCrcSize + 2;
+        std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(pacer.wireMicros(request_size))));
+        size_t size = encoder.encode(protocol::MSG_PONG, frame.payload, frame.length);
+        pacedWrite(master_fd, encoder.data(), size, pacer);
+    });
+    uint8_t buffer[256];
+    while (!stop) {
+        ssize_t n = readWithTimeout(master_fd, buffer, sizeof(buffer), 50);
+        if (n > 0) {
+            parser.feed(buffer, static_cast<size_t>(n));
+        }
+    }
+}
+
+// 往返延迟：主机发送 PING，对端回复 PONG
+bool benchLatency(PtyPair& pty, UART& uart, uint32_t baud, int rounds) {
+    std::atomic<bool> stop(false);
+    std::thread peer(echoPeer, pty.masterFd(), baud, std::ref(stop));
+
+    protocol::FrameEncoder encoder;
+    bool got_pong = false;
+    uint32_t expected = 0;
+    protocol::FrameParser parser([&](const protocol::Frame& frame) {
+        uint32_t value = 0;
+        if (frame.type == protocol::MSG_PONG && frame.length == sizeof(value)) {
+            memcpy(&value, frame.payload, sizeof(value));
+            got_pong = value == expected;
+        }
+    });
+
+    std::vector<double> samples;
+    size_t frame_size = 0;
+    uint8_t buffer[256];
+    for (int i = 0; i < rounds; ++i) {
+        expected = static_cast<uint32_t>(i);
+        got_pong = false;
+        frame_size = encoder.encode(protocol::MSG_PING, reinterpret_cast<const uint8_t*>(&expected), sizeof(expected));
+        Clock::time_point start = Clock::now();
+        if (uart.send(encoder.data(), frame_size) != static_cast<int>(frame_size)) {
+            break;
+        }
+        while (!got_pong) {
+            int n = uart.receive(buffer, sizeof(buffer), 1000);
+            if (n <= 0) {
+                break;
+            }
+            parser.feed(buffer, static_cast<size_t>(n));
+        }
+        if (!got_pong) {
+            break;
+        }
+        samples.push_back(elapsedMicros(start, Clock::now()));
+    }
+    stop = true;
+    peer.join();
+
+    bool pass = static_cast<int>(samples.size()) == rounds;
+    std::ostringstream detail;
+    if (!samples.empty()) {
+        std::sort(samples.begin(), samples.end());
+        Pacer pacer(baud);
+        detail << std::fixed << std::setprecision(1) << "rounds=" << samples.size() << " min=" << samples.front()
+               << "us median=" << samples[samples.size() / 2]
+               << "us p99=" << samples[std::min(samples.size() - 1, static_cast<size_t>(samples.size() * 0.99))]
+               << "us wire=" << pacer.wireMicros(2 * frame_size) << "us";
+    } else {
+        detail << "no round trips completed";
+    }
+    report("latency", pass, detail.str());
+    return pass;
+}
+
+// 二进制透明：负载覆盖全部 256 个字节值往返一次，检查串口配置没有改写控制字符（XON/XOFF、回车等）
+bool benchTransparency(PtyPair& pty, UART& uart, uint32_t baud) {
+    std::atomic<bool> stop(false);
+    std::thread peer(echoPeer, pty.masterFd(), baud, std::ref(stop));
+
+    std::vector<uint8_t> expected;
+    bool matched = false;
+    protocol::FrameParser parser([&](const protocol::Frame& frame) {
+        matched = frame.type == protocol::MSG_PONG && frame.length == expected.size() &&
+                  memcmp(frame.payload, &expected[0], expected.size()) == 0;
+    });
+
+    protocol::FrameEncoder encoder;
+    int passed = 0;
+    uint8_t buffer[512];
+    for (int part = 0; part < 2; ++part) {
+        // 两帧负载合起来覆盖 0x00~0xFF
+        expected.clear();
+        for (int value = part * 128; value < (part + 1) * 128; ++value) {
+            expected.push_back(static_cast<uint8_t>(value));
+        }
+        matched = false;
+        size_t size = encoder.encode(protocol::MSG_PING, &expected[0], expected.size());
+        if (uart.send(encoder.data(), size) != static_cast<int>(size)) {
+            break;
+        }
+        uint64_t frames = parser.stats().frames;
+        while (parser.stats().frames == frames) {
+            int n = uart.receive(buffer, sizeof(buffer), 1000);
+            if (n <= 0) {
+                break;
+            }
+            parser.feed(buffer, static_cast<size_t>(n));
+        }
+        passed += matched ? 1 : 0;
+    }
+    stop = true;
+    peer.join();
+
+    const protocol::FrameParser::Stats& stats = parser.stats();
+    bool pass = passed == 2 && stats.crc_errors == 0 && stats.framing_errors == 0;
+    std::ostringstream detail;
+    detail << "echoed=" << passed << "/2 crc_errors=" << stats.crc_errors << " framing_errors=" << stats.framing_errors;
+    report("transparency", pass, detail.str());
+    return pass;
+}
+
+// 持续吞吐：对端限速发送识别结果，每帧 batch 个结果，以 QUIT 帧结束
+bool benchThroughput(PtyPair& pty, UART& uart, uint32_t baud, double seconds, size_t batch) {
+    uint64_t sent_results = 0;
+    std::thread peer([&]() {
+        Pacer pacer(baud);
+        protocol::FrameEncoder encoder;
+        protocol::ResultBatch results;
+        Clock::time_point end = Clock::now() + std::chrono::microseconds(static_cast<int64_t>(seconds * 1e6));
+        while (Clock::now() < end) {
+            for (size_t i = 0; i < batch; ++i) {
+                results.add(makeResult(static_cast<uint32_t>(sent_results++)));
+            }
+            size_t size = results.flush(encoder);
+            if (!pacedWrite(pty.masterFd(), encoder.data(), size, pacer)) {
+                break;
+            }
+        }
+        size_t size = encoder.encode(protocol::MSG_QUIT, NULL, 0);
+        pacedWrite(pty.masterFd(), encoder.data(), size, pacer);
+    });
+
+    uint64_t received_results = 0;
+    uint64_t bad_results = 0;
+    bool done = false;
+    protocol::DetectionResult decoded[protocol::kMaxResultsPerFrame];
+    protocol::FrameParser parser([&](const protocol::Frame& frame) {
+        if (frame.type == protocol::MSG_QUIT) {
+            done = true;
+            return;
+        }
+        int count = protocol::decodeResults(frame.payload, frame.length, decoded, protocol::kMaxResultsPerFrame);
+        if (count < 0) {
+            ++bad_results;
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            if (decoded[i].timestamp_ms != received_results++) {
+                ++bad_results;
+            }
+        }
+    });
+
+    uint64_t bytes = 0;
+    uint64_t reads = 0;
+    uint8_t buffer[4096];
+    Clock::time_point start = Clock::now();
+    while (!done) {
+        int n = uart.receive(buffer, sizeof(buffer), 1000);
+        if (n <= 0) {
+            break;
+        }
+        bytes += static_cast<uint64_t>(n);
+        ++reads;
+        parser.feed(buffer, static_cast<size_t>(n));
+    }
+    double elapsed = elapsedMicros(start, Clock::now()) / 1e6;
+    peer.join();
+
+    const protocol::FrameParser::Stats& stats = parser.stats();
+    bool pass = done && received_results == sent_results && bad_results == 0 && stats.crc_errors == 0 &&
+                stats.framing_errors == 0 && stats.sequence_gaps == 0;
+    std::ostringstream detail;
+    detail << std::fixed << std::setprecision(0) << "batch=" << batch << " results/s=" << received_results / elapsed
+           << " frames/s=" << stats.frames / elapsed << " bytes/s=" << bytes / elapsed
+           << " bytes/read=" << (reads > 0 ? bytes / reads : 0) << " lost=" << (sent_results - received_results);
+    report("throughput", pass, detail.str());
+    return pass;
+}
+
+// 分片：帧被随机拆成 1~7 字节并间隔发送，中间插入一段垃圾数据和一个损坏的帧
+bool benchFragmentation(PtyPair& pty, UART& uart, int frames) {
+    std::thread peer([&]() {
+        protocol::FrameEncoder encoder;
+        protocol::ResultBatch results;
+        std::vector<uint8_t> stream;
+        for (int i = 0; i < frames; ++i) {
+            for (int k = 0; k <= i % 3; ++k) {
+                results.add(makeResult(static_cast<uint32_t>(i)));
+            }
+            size_t size = results.flush(encoder);
+            stream.insert(stream.end(), encoder.data(), encoder.data() + size);
+
+            if (i == frames / 3) {
+                // 不完整的 COBS 块：一个格式错误
+                const uint8_t garbage[] = {0x05, 0x07, 0x00};
+                stream.insert(stream.end(), garbage, garbage + sizeof(garbage));
+            }
+            if (i == frames * 2 / 3) {
+                // 负载中翻转一位：一个 CRC 错误
+                uint8_t payload[20];
+                memset(payload, 0x10, sizeof(payload));
+                uint8_t corrupted[protocol::kMaxEncodedSize];
+                size_t size = protocol::encodeFrame(protocol::MSG_RESULTS, 1, payload, sizeof(payload), corrupted,
+                                                    sizeof(corrupted));
+                corrupted[5] ^= 0x01;
+                stream.insert(stream.end(), corrupted, corrupted + size);
+            }
+        }
+        size_t size = encoder.encode(protocol::MSG_QUIT, NULL, 0);
+        stream.insert(stream.end(), encoder.data(), encoder.data() + size);
+
+        unsigned int seed = 1;
+        for (size_t offset = 0; offset < stream.size();) {
+            size_t chunk = std::min<size_t>(1 + rand_r(&seed) % 7, stream.size() - offset);
+            writeAll(pty.masterFd(), &stream[offset], chunk);
+            offset += chunk;
+            if (rand_r(&seed) % 4 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(rand_r(&seed) % 300));
+            }
+        }
+    });
+
+    bool done = false;
+    protocol::FrameParser parser([&](const protocol::Frame& frame) {
+        if (frame.type == protocol::MSG_QUIT) {
+            done = true;
+        }
+    });
+    uint64_t reads = 0;
+    uint8_t buffer[256];
+    while (!done) {
+        int n = uart.receive(buffer, sizeof(buffer), 1000);
+        if (n <= 0) {
+            break;
+        }
+        ++reads;
+        parser.feed(buffer, static_cast<size_t>(n));
+    }
+    peer.join();
+
+    const protocol::FrameParser::Stats& stats = parser.stats();
+    bool pass = done && stats.frames == static_cast<uint64_t>(frames) + 1 && stats.crc_errors == 1 &&
+                stats.framing_errors == 1 && stats.sequence_gaps == 0;
+    std::ostringstream detail;
+    detail << "frames=" << stats.frames << "/" << frames + 1 << " reads=" << reads << " crc_errors=" << stats.crc_errors
+           << "/1 framing_errors=" << stats.framing_errors << "/1 sequence_gaps=" << stats.sequence_gaps;
+    report("fragmentation", pass, detail.str());
+    return pass;
+}
+
+// 超时：无数据时 receive 应在超时后返回0；数据晚到时应立即返回
+bool benchTimeout(PtyPair& pty, UART& uart) {
+    const int kTimeoutMs = 50;
+    const int kLateMs = 20;
+    uint8_t buffer[64];
+
+    double idle_max = 0;
+    bool pass = true;
+    for (int i = 0; i < 5; ++i) {
+        Clock::time_point start = Clock::now();
+        int n = uart.receive(buffer, sizeof(buffer), kTimeoutMs);
+        double elapsed_ms = elapsedMicros(start, Clock::now()) / 1000;
+        idle_max = std::max(idle_max, elapsed_ms);
+        pass = pass && n == 0 && elapsed_ms >= kTimeoutMs * 0.9 && elapsed_ms < kTimeoutMs * 3;
+    }
+
+    std::thread peer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kLateMs));
+        const uint8_t byte = 0x55;
+        writeAll(pty.masterFd(), &byte, 1);
+    });
+    Clock::time_point start = Clock::now();
+    int n = uart.receive(buffer, sizeof(buffer), 1000);
+    double late_ms = elapsedMicros(start, Clock::now()) / 1000;
+    peer.join();
+    pass = pass && n == 1 && buffer[0] == 0x55 && late_ms < kLateMs + 20;
+
+    std::ostringstream detail;
+    detail << std::fixed << std::setprecision(1) << "idle_timeout=" << kTimeoutMs << "ms worst=" << idle_max
+           << "ms late_data=" << kLateMs << "ms woke_after=" << late_ms << "ms";
+    report("timeout", pass, detail.str());
+    return pass;
+}
+
+// 突发：双向各一次不限速写入 64KB，检查 send 是否写完、对端是否全部收到
+bool benchBurst(PtyPair& pty, UART& uart) {
+    const size_t kBurstBytes = 64 * 1024;
+
+    // 构造突发数据：连续的结果帧
+    protocol::FrameEncoder encoder;
+    protocol::ResultBatch results;
+    std::vector<uint8_t> stream;
+    uint64_t frames = 0;
+    while (stream.size() < kBurstBytes) {
+        while (results.add(makeResult(static_cast<uint32_t>(frames)))) {
+        }
+        size_t size = results.flush(encoder);
+        stream.insert(stream.end(), encoder.data(), encoder.data() + size);
+        ++frames;
+    }
+
+    // 主机 -> 对端：一次 UART::send
+    uint64_t peer_frames = 0;
+    std::thread peer([&]() {
+        protocol::FrameParser parser([&](const protocol::Frame&) { ++peer_frames; });
+        uint8_t buffer[4096];
+        while (peer_frames < frames) {
+            ssize_t n = readWithTimeout(pty.masterFd(), buffer, sizeof(buffer), 1000);
+            if (n <= 0) {
+                break;
+            }
+            parser.feed(buffer, static_cast<size_t>(n));
+        }
+    });
+    Clock::time_point start = Clock::now();
+    int sent = uart.send(&stream[0], stream.size());
+    peer.join();
+    double tx_ms = elapsedMicros(start, Clock::now()) / 1000;
+    bool tx_pass = sent == static_cast<int>(stream.size()) && peer_frames == frames;
+
+    // 对端 -> 主机：一次写入
+    peer = std::thread([&]() { writeAll(pty.masterFd(), &stream[0], stream.size()); });
+    uint64_t host_frames = 0;
+    protocol::FrameParser parser([&](const protocol::Frame&) { ++host_frames; });
+    uint8_t buffer[4096];
+    start = Clock::now();
+    while (host_frames < frames) {
+        int n = uart.receive(buffer, sizeof(buffer), 1000);
+        if (n <= 0) {
+            break;
+        }
+        parser.feed(buffer, static_cast<size_t>(n));
+    }
+    double rx_ms = elapsedMicros(start, Clock::now()) / 1000;
+    peer.join();
+    bool rx_pass = host_frames == frames && parser.stats().crc_errors == 0 && parser.stats().framing_errors == 0;
+
+    std::ostringstream detail;
+    detail << std::fixed << std::setprecision(1) << "bytes=" << stream.size() << " tx_sent=" << sent
+           << " tx_frames=" << peer_frames << "/" << frames << " (" << tx_ms << "ms) rx_frames=" << host_frames << "/"
+           << frames << " (" << rx_ms << "ms)";
+    report("burst", tx_pass && rx_pass, detail.str());
+    return tx_pass && rx_pass;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    // 解析命令行参数
+    uint32_t baud = 115200;
+    int rounds = 200;
+    double seconds = 2.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--baud" && i + 1 < argc) {
+            baud = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (arg == "--rounds" && i + 1 < argc) {
+            rounds = std::max(1, atoi(argv[++i]));
+        } else if (arg == "--seconds" && i + 1 < argc) {
+            seconds = std::max(0.1, atof(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--baud N (0 = unpaced)] [--rounds N] [--seconds S]" << std::endl;
+            return -1;
+        }
+    }
+
+    // 看门狗：send 被流控卡住等情况会永久阻塞，超时后进程被 SIGALRM 终止，视为失败
+    alarm(static_cast<unsigned int>(60 + 2 * seconds));
+
+    PtyPair pty;
+    if (!pty.open()) {
+        return -1;
+    }
+    UART uart;
+    if (!uart.init(pty.slavePath(), baud > 0 ? baud : 115200)) {
+        return -1;
+    }
+    std::cout << "pty " << pty.slavePath() << ", simulated baud " << (baud > 0 ? std::to_string(baud) : "unpaced")
+              << std::endl;
+
+    bool pass = true;
+    pass = benchLatency(pty, uart, baud, rounds) && pass;
+    drain(pty.masterFd(), uart);
+    pass = benchTransparency(pty, uart, baud) && pass;
+    drain(pty.masterFd(), uart);
+    pass = benchThroughput(pty, uart, baud, seconds, 1) && pass;
+    drain(pty.masterFd(), uart);
+    pass = benchThroughput(pty, uart, baud, seconds, protocol::kMaxResultsPerFrame) && pass;
+    drain(pty.masterFd(), uart);
+    pass = benchFragmentation(pty, uart, 500) && pass;
+    drain(pty.masterFd(), uart);
+    pass = benchTimeout(pty, uart) && pass;
+    drain(pty.masterFd(), uart);
+    pass = benchBurst(pty, uart) && pass;
+
+    uart.close();
+    std::cout << (pass ? "All checks passed" : "Some checks FAILED") << std::endl;
+    return pass ? 0 : 1;
+}
\ No newline at end of file
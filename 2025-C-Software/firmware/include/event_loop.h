@@ -0,0 +1,111 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+
+/**
+ * 基于 epoll 的事件循环
+ * 在一个线程中同时等待串口等文件描述符、timerfd 定时器和 eventfd 唤醒，
+ * 有数据到达时立即分发给对应的处理函数，空闲时不产生任何唤醒
+ * 除 post 和 stop 外，所有接口只能在事件循环线程中（或 run 之前）调用
+ */
+class EventLoop {
+public:
+    /**
+     * 文件描述符事件处理函数，参数为 epoll 事件掩码（EPOLLIN/EPOLLERR/...）
+     */
+    typedef std::function<void(uint32_t events)> FdHandler;
+
+    /**
+     * 定时器和投递任务的处理函数
+     */
+    typedef std::function<void()> Task;
+
+    /**
+     * 构造函数
+     */
+    EventLoop();
+
+    /**
+     * 析构函数
+     */
+    ~EventLoop();
+
+    /**
+     * 创建 epoll 和 eventfd
+     * @return 是否初始化成功
+     */
+    bool init();
+
+    /**
+     * 监听文件描述符
+     * @param fd 文件描述符，所有权仍归调用者
+     * @param events 关注的事件（水平触发），如 EPOLLIN
+     * @param handler 事件处理函数
+     * @return 是否添加成功
+     */
+    bool addFd(int fd, uint32_t events, FdHandler handler);
+
+    /**
+     * 停止监听文件描述符，可在处理函数中调用
+     * @param fd 文件描述符
+     */
+    void removeFd(int fd);
+
+    /**
+     * 添加周期定时器
+     * @param interval_ms 周期（毫秒）
+     * @param handler 到期处理函数，错过多个周期时只调用一次
+     * @return 定时器ID，失败返回-1
+     */
+    int addTimer(int interval_ms, Task handler);
+
+    /**
+     * 删除定时器
+     * @param timer_id addTimer 返回的定时器ID
+     */
+    void removeTimer(int timer_id);
+
+    /**
+     * 从任意线程投递任务到事件循环线程执行
+     * @param task 任务
+     */
+    void post(Task task);
+
+    /**
+     * 运行事件循环，直到 stop 被调用
+     */
+    void run();
+
+    /**
+     * 请求事件循环退出，可从任意线程调用
+     */
+    void stop();
+
+    /**
+     * 检查当前线程是否为事件循环线程
+     * @return 是否在事件循环线程中
+     */
+    bool isInLoopThread() const;
+
+private:
+    // 执行所有投递的任务
+    void runPendingTasks();
+
+    int epoll_fd_; // epoll 文件描述符
+    int wakeup_fd_; // eventfd，用于 post/stop 唤醒
+    std::map<int, FdHandler> handlers_; // 文件描述符 -> 处理函数
+    std::vector<int> timer_fds_; // 定时器的 timerfd
+    std::mutex pending_mutex_; // 保护投递任务队列
+    std::vector<Task> pending_tasks_; // 投递的任务
+    std::atomic<bool> running_; // 是否运行中
+    std::thread::id loop_thread_; // 事件循环线程ID
+};
+
+#endif // EVENT_LOOP_H
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef FRAME_GRABBER_H
+#define FRAME_GRABBER_H
+
+#include <opencv2/opencv.hpp>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/**
+ * 后台取帧类
+ * 在独立线程中持续读取摄像头，只保留最新一帧，
+ * 触发识别时直接取用已解码好的图像，不需要等待曝光和解码
+ * 读取失败（如 USB 摄像头断开）时丢弃最新一帧，使 latest 报告没有可用的帧而不是返回过期图像，
+ * 然后以指数退避重新打开视频源，恢复后继续取帧（视频文件读完时同样重新打开，即循环播放）
+ */
+class FrameGrabber {
+public:
+    /**
+     * 构造函数
+     */
+    FrameGrabber();
+
+    /**
+     * 析构函数
+     */
+    ~FrameGrabber();
+
+    /**
+     * 打开视频源
+     * @param source 摄像头编号（如 "0"）或设备路径/视频文件
+     * @param width 期望宽度，0表示使用默认值
+     * @param height 期望高度，0表示使用默认值
+     * @return 是否打开成功
+     */
+    bool open(const std::string& source, int width = 0, int height = 0);
+
+    /**
+     * 启动后台取帧线程
+     * @return 是否启动成功
+     */
+    bool start();
+
+    /**
+     * 停止后台取帧线程并关闭视频源
+     */
+    void stop();
+
+    /**
+     * 获取最新一帧
+     * 返回的图像与取帧线程共享数据，但取帧线程每帧使用新的缓冲区，调用者可以安全读取
+     * @param frame 输出图像
+     * @param sequence 输出帧序号
+     * @param capture_us 输出采集完成时间（monotonicMicros）
+     * @return 是否已有可用的帧
+     */
+    bool latest(cv::Mat& frame, uint64_t& sequence, int64_t& capture_us) const;
+
+    /**
+     * 获取已采集的帧数
+     * @return 帧数
+     */
+    uint64_t framesCaptured() const;
+
+    /**
+     * 获取读取失败后重新打开视频源成功的次数
+     * @return 次数
+     */
+    uint64_t reconnects() const;
+
+private:
+    // 按 open 时的参数打开视频源
+    bool openSource();
+
+    // 等待指定时间，stop 被调用时提前返回
+    void waitFor(int milliseconds);
+
+    // 取帧线程函数
+    void captureThread();
+
+    std::string source_; // 视频源
+    int width_; // 期望宽度
+    int height_; // 期望高度
+    cv::VideoCapture capture_; // 视频源
+    mutable std::mutex mutex_; // 保护最新一帧
+    cv::Mat latest_; // 最新一帧
+    uint64_t sequence_; // 最新一帧的序号
+    int64_t capture_us_; // 最新一帧的采集时间
+    uint64_t reconnects_; // 重新打开视频源的次数
+    std::condition_variable stop_cv_; // 唤醒退避等待中的取帧线程
+    std::atomic<bool> running_; // 是否运行中
+    std::thread thread_; // 取帧线程
+};
+
+#endif // FRAME_GRABBER_H
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef LATENCY_RECORDER_H
+#define LATENCY_RECORDER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/**
+ * 获取单调时钟时间
+ * @return 微秒
+ */
+int64_t monotonicMicros();
+
+/**
+ * 延迟记录器
+ * 在固定大小的窗口中保存最近的延迟样本，用于周期输出最小值、中位数、p99 和最大值
+ * 记录时不分配内存；非线程安全，只在一个线程（事件循环线程）中使用
+ */
+class LatencyRecorder {
+public:
+    /**
+     * 统计结果（微秒）
+     */
+    struct Summary {
+        size_t count; // 样本数
+        int64_t min_us; // 最小值
+        int64_t median_us; // 中位数
+        int64_t p99_us; // p99
+        int64_t max_us; // 最大值
+    };
+
+    /**
+     * 构造函数
+     * @param capacity 保存的最近样本数
+     */
+    explicit LatencyRecorder(size_t capacity = 1024);
+
+    /**
+     * 记录一个样本
+     * @param micros 延迟（微秒）
+     */
+    void record(int64_t micros);
+
+    /**
+     * 统计窗口内的样本
+     * @return 统计结果，没有样本时全部为0
+     */
+    Summary summarize() const;
+
+    /**
+     * 清空样本
+     */
+    void reset();
+
+private:
+    std::vector<int64_t> samples_; // 环形样本窗口
+    size_t next_; // 下一个样本的写入位置
+    size_t count_; // 有效样本数
+};
+
+#endif // LATENCY_RECORDER_H
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define PIC_DEAL_H
 
 #include <opencv2/opencv.hpp>
+#include <vector>
 
 /**
  * 图像处理类
@@ -60,8 +61,26 @@ public:
      */
     cv::Mat& getCurrentImage();
 
+    /**
+     * 设置当前图像（共享数据，不拷贝）
+     * @param image BGR 或灰度图像
+     */
+    void setImage(const cv::Mat& image);
+
+    /**
+     * 检测当前图像中的正方形
+     * 中间图像保存在成员中复用，连续调用时不重复分配内存
+     * @param squares 输出的正方形顶点，按面积从小到大排序
+     * @return 是否有可处理的图像
+     */
+    bool detectSquares(std::vector<std::vector<cv::Point2f>>& squares);
+
 private:
     cv::Mat current_image_; // 当前处理的图像
+    cv::Mat gray_; // 检测用的灰度图像
+    cv::Mat blurred_; // 检测用的模糊图像
+    cv::Mat edges_; // 检测用的边缘图像
+    std::vector<std::vector<cv::Point>> contours_; // 检测用的轮廓
 };
 
 #endif // PIC_DEAL_H
\ No newline at end of file
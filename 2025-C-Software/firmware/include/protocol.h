@@ -0,0 +1,236 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+
+/**
+ * 串口二进制帧协议
+ *
+ * 帧格式（COBS 编码前）：
+ *   [类型 1B][序号 1B][负载 0~kMaxPayload B][CRC16 2B，小端]
+ * CRC16-CCITT（多项式 0x1021，初值 0xFFFF）覆盖类型、序号和负载；
+ * 整帧经 COBS 编码后以 0x00 结尾，帧内不会出现 0x00，
+ * 接收方可以在任意字节处重新同步，读取被拆分或合并都不影响解析
+ *
+ * 多字节整数均为小端；坐标和长度使用 Q12.4 定点数（1/16 像素）
+ */
+
+namespace protocol {
+
+// 消息类型
+enum MessageType {
+    MSG_PING = 0x01,    // 心跳请求，负载原样返回
+    MSG_PONG = 0x02,    // 心跳应答
+    MSG_TRIGGER = 0x10, // 请求识别一帧
+    MSG_RESULTS = 0x20, // 识别结果批量帧
+    MSG_QUIT = 0x7F     // 请求固件退出
+};
+
+const size_t kMaxPayload = 250; // 负载最大长度，整帧不超过一个 COBS 块
+const size_t kHeaderSize = 2; // 类型和序号
+const size_t kCrcSize = 2; // CRC16
+const size_t kMaxFrameSize = kHeaderSize + kMaxPayload + kCrcSize; // 解码后的最大帧长
+const size_t kMaxEncodedSize = kMaxFrameSize + kMaxFrameSize / 254 + 2; // 编码后的最大帧长（含结尾 0x00）
+
+/**
+ * 计算 CRC16-CCITT
+ * @param data 数据
+ * @param len 数据长度
+ * @param crc 初值，可用于分段计算
+ * @return CRC 值
+ */
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+/**
+ * 编码一帧：计算 CRC、COBS 编码并追加 0x00 结尾
+ * @param type 消息类型
+ * @param seq 序号
+ * @param payload 负载
+ * @param len 负载长度，不超过 kMaxPayload
+ * @param out 输出缓冲区
+ * @param out_capacity 输出缓冲区长度，不小于 kMaxEncodedSize 时一定足够
+ * @return 编码后的长度，参数无效或空间不足时返回0
+ */
+size_t encodeFrame(uint8_t type, uint8_t seq, const uint8_t* payload, size_t len, uint8_t* out, size_t out_capacity);
+
+/**
+ * 解析出的一帧
+ * payload 指向解析器内部缓冲区，只在回调期间有效
+ */
+struct Frame {
+    uint8_t type; // 消息类型
+    uint8_t seq; // 序号
+    const uint8_t* payload; // 负载
+    size_t length; // 负载长度
+};
+
+/**
+ * 增量帧解析器
+ * 逐字节进行 COBS 解码，遇到 0x00 时校验 CRC 并回调；
+ * 使用固定大小的内部缓冲区，解析过程中不分配内存
+ */
+class FrameParser {
+public:
+    /**
+     * 帧回调函数
+     */
+    typedef std::function<void(const Frame& frame)> FrameHandler;
+
+    /**
+     * 解析统计
+     */
+    struct Stats {
+        uint64_t frames; // 校验通过的帧数
+        uint64_t crc_errors; // CRC 错误的帧数
+        uint64_t framing_errors; // 过长、过短或 COBS 格式错误的帧数
+        uint64_t sequence_gaps; // 序号不连续的次数
+    };
+
+    /**
+     * 构造函数
+     * @param handler 帧回调函数
+     */
+    explicit FrameParser(FrameHandler handler);
+
+    /**
+     * 输入接收到的字节，可以是任意长度的片段
+     * @param data 数据
+     * @param len 数据长度
+     */
+    void feed(const uint8_t* data, size_t len);
+
+    /**
+     * 丢弃当前未完成的帧
+     */
+    void reset();
+
+    /**
+     * 获取解析统计
+     * @return 统计信息
+     */
+    const Stats& stats() const;
+
+private:
+    // 一帧结束（收到 0x00）
+    void finishFrame();
+
+    FrameHandler handler_; // 帧回调函数
+    uint8_t buffer_[kMaxFrameSize]; // 解码后的帧
+    size_t length_; // 已解码的字节数
+    uint8_t code_; // 当前 COBS 块的长度码
+    uint8_t remaining_; // 当前 COBS 块剩余的数据字节数
+    bool overflow_; // 当前帧是否超长或格式错误
+    bool has_last_seq_; // 是否收到过帧
+    uint8_t last_seq_; // 上一帧的序号
+    Stats stats_; // 解析统计
+};
+
+/**
+ * 帧编码器
+ * 维护发送序号，把一帧编码到内部缓冲区，不分配内存
+ */
+class FrameEncoder {
+public:
+    /**
+     * 构造函数
+     */
+    FrameEncoder();
+
+    /**
+     * 编码一帧，序号自动递增
+     * @param type 消息类型
+     * @param payload 负载
+     * @param len 负载长度，不超过 kMaxPayload
+     * @return 编码后的长度，失败返回0
+     */
+    size_t encode(uint8_t type, const uint8_t* payload, size_t len);
+
+    /**
+     * 获取最近一次编码的数据
+     * @return 编码后的数据
+     */
+    const uint8_t* data() const;
+
+    /**
+     * 获取最近一次编码的长度
+     * @return 字节数
+     */
+    size_t size() const;
+
+private:
+    uint8_t buffer_[kMaxEncodedSize]; // 编码后的帧
+    size_t size_; // 编码后的长度
+    uint8_t seq_; // 下一帧的序号
+};
+
+/**
+ * 一个识别结果
+ */
+struct DetectionResult {
+    float corners[4][2]; // 正方形四个顶点（像素）
+    float edge_length; // 边长（像素）
+    uint8_t class_id; // 类别ID，未分类为 0xFF
+    uint32_t timestamp_ms; // 采集时间戳（毫秒，可回绕）
+};
+
+const size_t kResultSize = 4 * 2 * 2 + 2 + 1 + 4; // 单个结果的编码长度
+const size_t kMaxResultsPerFrame = (kMaxPayload - 1) / kResultSize; // 每帧最多的结果数
+
+/**
+ * 识别结果批量打包
+ * 负载格式：[结果数 1B][结果 0][结果 1]...，每个结果为
+ * 8 个 int16 顶点坐标（Q12.4）、uint16 边长（Q12.4）、uint8 类别ID、uint32 时间戳
+ */
+class ResultBatch {
+public:
+    /**
+     * 构造函数
+     */
+    ResultBatch();
+
+    /**
+     * 追加一个结果
+     * @param result 识别结果，坐标超出 Q12.4 范围时截断
+     * @return 批次已满时返回false，结果未被加入
+     */
+    bool add(const DetectionResult& result);
+
+    /**
+     * 把当前批次编码为一帧并清空批次
+     * @param encoder 帧编码器
+     * @return 编码后的长度，批次为空时返回0
+     */
+    size_t flush(FrameEncoder& encoder);
+
+    /**
+     * 获取当前批次的结果数
+     * @return 结果数
+     */
+    size_t count() const;
+
+    /**
+     * 检查批次是否已满
+     * @return 是否已满
+     */
+    bool full() const;
+
+private:
+    uint8_t payload_[kMaxPayload]; // 负载
+    size_t count_; // 结果数
+};
+
+/**
+ * 解码识别结果批量帧的负载
+ * @param payload 负载
+ * @param len 负载长度
+ * @param results 输出结果
+ * @param max_results 输出数组长度
+ * @return 解码出的结果数，负载格式错误返回-1
+ */
+int decodeResults(const uint8_t* payload, size_t len, DetectionResult* results, size_t max_results);
+
+} // namespace protocol
+
+#endif // PROTOCOL_H
\ No newline at end of file
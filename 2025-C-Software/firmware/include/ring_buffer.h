@@ -0,0 +1,96 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+/**
+ * 字节环形缓冲区
+ * 容量向上取整为2的幂，读写位置单调递增，用掩码取下标；
+ * 串口数据直接从 fd 读入空闲区域，不经过中间缓冲区
+ * 非线程安全，只在一个线程（事件循环线程）中使用
+ */
+class RingBuffer {
+public:
+    /**
+     * 构造函数
+     * @param capacity 最小容量（字节）
+     */
+    explicit RingBuffer(size_t capacity);
+
+    /**
+     * 写入数据，空间不足时只写入能放下的部分
+     * @param data 数据
+     * @param len 数据长度
+     * @return 实际写入的字节数
+     */
+    size_t write(const uint8_t* data, size_t len);
+
+    /**
+     * 读出并移除数据
+     * @param data 输出缓冲区
+     * @param len 最多读取的字节数
+     * @return 实际读取的字节数
+     */
+    size_t read(uint8_t* data, size_t len);
+
+    /**
+     * 读取但不移除数据
+     * @param data 输出缓冲区
+     * @param len 最多读取的字节数
+     * @return 实际读取的字节数
+     */
+    size_t peek(uint8_t* data, size_t len) const;
+
+    /**
+     * 获取指定偏移处的字节
+     * @param index 相对最早一个字节的偏移，必须小于 size()
+     * @return 字节值
+     */
+    uint8_t at(size_t index) const;
+
+    /**
+     * 丢弃最早的若干字节
+     * @param len 字节数，超过 size() 时清空
+     */
+    void discard(size_t len);
+
+    /**
+     * 从文件描述符读取数据到空闲区域
+     * @param fd 文件描述符
+     * @return 读取的字节数，0表示对端关闭，-1表示出错（errno 有效，缓冲区已满时为 ENOBUFS）
+     */
+    long readFromFd(int fd);
+
+    /**
+     * 清空缓冲区
+     */
+    void clear();
+
+    /**
+     * 获取已缓存的字节数
+     * @return 字节数
+     */
+    size_t size() const;
+
+    /**
+     * 获取剩余空间
+     * @return 字节数
+     */
+    size_t space() const;
+
+    /**
+     * 获取容量
+     * @return 字节数
+     */
+    size_t capacity() const;
+
+private:
+    std::vector<uint8_t> buffer_; // 数据存储
+    size_t mask_; // 容量减一
+    size_t read_pos_; // 读位置（单调递增）
+    size_t write_pos_; // 写位置（单调递增）
+};
+
+#endif // RING_BUFFER_H
\ No newline at end of file
@@ -59,6 +59,12 @@ public:
      */
     bool isOpen() const;
 
+    /**
+     * 获取串口文件描述符，用于加入事件循环
+     * @return 文件描述符，未打开时为-1
+     */
+    int fd() const;
+
 private:
     int serial_fd_; // 串口文件描述符
     bool is_open_;  // 串口是否打开
@@ -0,0 +1,173 @@
+#include "event_loop.h"
+#include <iostream>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+EventLoop::EventLoop() : epoll_fd_(-1), wakeup_fd_(-1), running_(false) {
+    // 构造函数初始化
+}
+
+EventLoop::~EventLoop() {
+    // 析构函数关闭定时器和 epoll
+    for (size_t i = 0; i < timer_fds_.size(); ++i) {
+        ::close(timer_fds_[i]);
+    }
+    if (wakeup_fd_ >= 0) {
+        ::close(wakeup_fd_);
+    }
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+    }
+}
+
+bool EventLoop::init() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        std::cerr << "Failed to create epoll: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        std::cerr << "Failed to create eventfd: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // eventfd 可读时清零计数并执行投递的任务
+    int wakeup_fd = wakeup_fd_;
+    return addFd(wakeup_fd_, EPOLLIN, [this, wakeup_fd](uint32_t) {
+        uint64_t count;
+        ssize_t ignored = read(wakeup_fd, &count, sizeof(count));
+        (void)ignored;
+        runPendingTasks();
+    });
+}
+
+bool EventLoop::addFd(int fd, uint32_t events, FdHandler handler) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        std::cerr << "Failed to add fd " << fd << " to epoll: " << strerror(errno) << std::endl;
+        return false;
+    }
+    handlers_[fd] = handler;
+    return true;
+}
+
+void EventLoop::removeFd(int fd) {
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, NULL);
+    handlers_.erase(fd);
+}
+
+int EventLoop::addTimer(int interval_ms, Task handler) {
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        std::cerr << "Failed to create timerfd: " << strerror(errno) << std::endl;
+        return -1;
+    }
+
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    if (timerfd_settime(timer_fd, 0, &spec, NULL) < 0) {
+        std::cerr << "Failed to arm timerfd: " << strerror(errno) << std::endl;
+        ::close(timer_fd);
+        return -1;
+    }
+
+    // 到期时读出到期次数，多次到期只调用一次处理函数
+    bool added = addFd(timer_fd, EPOLLIN, [timer_fd, handler](uint32_t) {
+        uint64_t expirations;
+        if (read(timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+            handler();
+        }
+    });
+    if (!added) {
+        ::close(timer_fd);
+        return -1;
+    }
+    timer_fds_.push_back(timer_fd);
+    return timer_fd;
+}
+
+void EventLoop::removeTimer(int timer_id) {
+    for (size_t i = 0; i < timer_fds_.size(); ++i) {
+        if (timer_fds_[i] == timer_id) {
+            removeFd(timer_id);
+            ::close(timer_id);
+            timer_fds_.erase(timer_fds_.begin() + i);
+            return;
+        }
+    }
+}
+
+void EventLoop::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        pending_tasks_.push_back(task);
+    }
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeup_fd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void EventLoop::run() {
+    loop_thread_ = std::this_thread::get_id();
+    running_ = true;
+
+    struct epoll_event events[16];
+    while (running_) {
+        // 没有事件时无限等待，不做轮询
+        int n = epoll_wait(epoll_fd_, events, 16, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "epoll_wait error: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n && running_; ++i) {
+            // 处理函数可能删除自身或其他 fd，先拷贝再调用
+            std::map<int, FdHandler>::iterator it = handlers_.find(events[i].data.fd);
+            if (it == handlers_.end()) {
+                continue;
+            }
+            FdHandler handler = it->second;
+            handler(events[i].events);
+        }
+    }
+
+    running_ = false;
+    loop_thread_ = std::thread::id();
+}
+
+void EventLoop::stop() {
+    running_ = false;
+    // 唤醒可能阻塞在 epoll_wait 中的事件循环
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeup_fd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+bool EventLoop::isInLoopThread() const {
+    return loop_thread_ == std::this_thread::get_id();
+}
+
+void EventLoop::runPendingTasks() {
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        tasks.swap(pending_tasks_);
+    }
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        tasks[i]();
+    }
+}
\ No newline at end of file
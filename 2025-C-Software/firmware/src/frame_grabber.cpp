@@ -0,0 +1,138 @@
+#include "frame_grabber.h"
+#include "latency_recorder.h"
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <stdlib.h>
+
+namespace {
+
+const int kInitialBackoffMs = 100; // 第一次重新打开前的等待时间
+const int kMaxBackoffMs = 2000; // 重新打开的最长等待时间
+
+} // namespace
+
+FrameGrabber::FrameGrabber() : width_(0), height_(0), sequence_(0), capture_us_(0), reconnects_(0), running_(false) {
+    // 构造函数初始化
+}
+
+FrameGrabber::~FrameGrabber() {
+    // 析构函数停止取帧
+    stop();
+}
+
+bool FrameGrabber::open(const std::string& source, int width, int height) {
+    source_ = source;
+    width_ = width;
+    height_ = height;
+    if (!openSource()) {
+        std::cerr << "Failed to open video source: " << source << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool FrameGrabber::openSource() {
+    // 纯数字视为摄像头编号，否则视为设备路径或视频文件
+    char* end = NULL;
+    long index = strtol(source_.c_str(), &end, 10);
+    bool is_index = !source_.empty() && *end == '\0';
+    if (is_index ? !capture_.open(static_cast<int>(index)) : !capture_.open(source_)) {
+        return false;
+    }
+
+    if (width_ > 0 && height_ > 0) {
+        capture_.set(cv::CAP_PROP_FRAME_WIDTH, width_);
+        capture_.set(cv::CAP_PROP_FRAME_HEIGHT, height_);
+    }
+    // 驱动缓冲区尽量小，减少取到的帧的滞后
+    capture_.set(cv::CAP_PROP_BUFFERSIZE, 1);
+    return true;
+}
+
+bool FrameGrabber::start() {
+    if (running_) {
+        return true;
+    }
+    if (!capture_.isOpened()) {
+        std::cerr << "Video source not opened" << std::endl;
+        return false;
+    }
+    running_ = true;
+    thread_ = std::thread(&FrameGrabber::captureThread, this);
+    return true;
+}
+
+void FrameGrabber::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+        stop_cv_.notify_all();
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    capture_.release();
+}
+
+bool FrameGrabber::latest(cv::Mat& frame, uint64_t& sequence, int64_t& capture_us) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (latest_.empty()) {
+        return false;
+    }
+    frame = latest_;
+    sequence = sequence_;
+    capture_us = capture_us_;
+    return true;
+}
+
+uint64_t FrameGrabber::framesCaptured() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sequence_;
+}
+
+uint64_t FrameGrabber::reconnects() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reconnects_;
+}
+
+void FrameGrabber::waitFor(int milliseconds) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    stop_cv_.wait_for(lock, std::chrono::milliseconds(milliseconds), [this]() { return !running_; });
+}
+
+void FrameGrabber::captureThread() {
+    int backoff_ms = kInitialBackoffMs;
+    while (running_) {
+        // 每帧读入新的缓冲区，已交给调用者的帧不会被覆盖
+        cv::Mat frame;
+        if (capture_.read(frame) && !frame.empty()) {
+            int64_t now = monotonicMicros();
+            backoff_ms = kInitialBackoffMs;
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            latest_ = frame;
+            ++sequence_;
+            capture_us_ = now;
+            continue;
+        }
+
+        // 读取失败：先丢弃最新一帧，触发时不再返回过期图像，再退避后重新打开视频源
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            latest_.release();
+        }
+        std::cerr << "Failed to read frame, reopening " << source_ << std::endl;
+        capture_.release();
+        while (running_) {
+            waitFor(backoff_ms);
+            backoff_ms = std::min(backoff_ms * 2, kMaxBackoffMs);
+            if (running_ && openSource()) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++reconnects_;
+                std::cerr << "Reopened video source " << source_ << std::endl;
+                break;
+            }
+        }
+    }
+}
\ No newline at end of file
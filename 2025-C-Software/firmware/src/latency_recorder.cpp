@@ -0,0 +1,44 @@
+#include "latency_recorder.h"
+#include <algorithm>
+#include <time.h>
+
+int64_t monotonicMicros() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+}
+
+LatencyRecorder::LatencyRecorder(size_t capacity) : samples_(capacity > 0 ? capacity : 1), next_(0), count_(0) {
+    // 构造函数初始化
+}
+
+void LatencyRecorder::record(int64_t micros) {
+    samples_[next_] = micros;
+    next_ = (next_ + 1) % samples_.size();
+    if (count_ < samples_.size()) {
+        ++count_;
+    }
+}
+
+LatencyRecorder::Summary LatencyRecorder::summarize() const {
+    Summary summary;
+    summary.count = count_;
+    summary.min_us = summary.median_us = summary.p99_us = summary.max_us = 0;
+    if (count_ == 0) {
+        return summary;
+    }
+
+    // 只在输出统计时排序拷贝，记录路径保持 O(1)
+    std::vector<int64_t> sorted(samples_.begin(), samples_.begin() + count_);
+    std::sort(sorted.begin(), sorted.end());
+    summary.min_us = sorted.front();
+    summary.median_us = sorted[count_ / 2];
+    summary.p99_us = sorted[std::min(count_ - 1, count_ * 99 / 100)];
+    summary.max_us = sorted.back();
+    return summary;
+}
+
+void LatencyRecorder::reset() {
+    next_ = 0;
+    count_ = 0;
+}
\ No newline at end of file
@@ -1,14 +1,58 @@
 #include <iostream>
 #include <string>
+#include <vector>
+#include <stdlib.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 #include "pic_deal.h"
 #include "uart.h"
+#include "event_loop.h"
+#include "ring_buffer.h"
+#include "protocol.h"
+#include "frame_grabber.h"
+#include "latency_recorder.h"
+
+namespace {
+
+// 输出一组延迟统计
+void printLatency(const char* name, const LatencyRecorder& recorder) {
+    LatencyRecorder::Summary summary = recorder.summarize();
+    std::cout << "  " << name << ": n=" << summary.count << " min=" << summary.min_us << "us median="
+              << summary.median_us << "us p99=" << summary.p99_us << "us max=" << summary.max_us << "us" << std::endl;
+}
+
+} // namespace
 
 int main(int argc, char** argv) {
+    // 解析命令行参数
+    std::string port = "/dev/ttyS0";
+    uint32_t baud_rate = 115200;
+    std::string camera = "0";
+    std::string image_path;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) {
+            port = argv[++i];
+        } else if (arg == "--baud" && i + 1 < argc) {
+            baud_rate = static_cast<uint32_t>(atoi(argv[++i]));
+        } else if (arg == "--camera" && i + 1 < argc) {
+            camera = argv[++i];
+        } else if (arg == "--image" && i + 1 < argc) {
+            image_path = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--port DEV] [--baud N] [--camera INDEX|PATH] [--image FILE]"
+                      << std::endl;
+            return -1;
+        }
+    }
+
     std::cout << "Firmware started" << std::endl;
 
     // 初始化UART
     UART uart;
-    if (!uart.init("/dev/ttyS0", 115200)) {
+    if (!uart.init(port, baud_rate)) {
         std::cerr << "Failed to initialize UART" << std::endl;
         return -1;
     }
@@ -17,46 +61,198 @@ int main(int argc, char** argv) {
     // 初始化图像处理类
     PicDeal pic_deal;
 
-    // 示例：读取图像
-    // if (!pic_deal.readImage("image.jpg")) {
-    //     std::cerr << "Failed to read image" << std::endl;
-    //     uart.close();
-    //     return -1;
-    // }
-    // std::cout << "Image read successfully" << std::endl;
-
-    // 主循环
-    bool running = true;
-    while (running) {
-        // 接收UART数据
-        uint8_t buffer[128];
-        int bytes_read = uart.receive(buffer, sizeof(buffer));
-
-        if (bytes_read > 0) {
-            std::cout << "Received data: ";
-            for (int i = 0; i < bytes_read; ++i) {
-                std::cout << std::hex << static_cast<int>(buffer[i]) << " ";
+    // 图像来源：指定 --image 时每次触发都识别这张静态图像（用于台架测试），
+    // 否则后台线程持续取帧，触发时直接使用最新一帧
+    cv::Mat static_image;
+    FrameGrabber grabber;
+    if (!image_path.empty()) {
+        if (!pic_deal.readImage(image_path)) {
+            uart.close();
+            return -1;
+        }
+        static_image = pic_deal.getCurrentImage();
+        std::cout << "Image read successfully" << std::endl;
+    } else if (!grabber.open(camera) || !grabber.start()) {
+        std::cerr << "Failed to start camera " << camera << std::endl;
+        uart.close();
+        return -1;
+    }
+
+    // 初始化事件循环
+    EventLoop loop;
+    if (!loop.init()) {
+        std::cerr << "Failed to initialize event loop" << std::endl;
+        uart.close();
+        return -1;
+    }
+
+    // SIGINT/SIGTERM 通过 signalfd 交给事件循环处理
+    sigset_t signal_mask;
+    sigemptyset(&signal_mask);
+    sigaddset(&signal_mask, SIGINT);
+    sigaddset(&signal_mask, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signal_mask, NULL);
+    int signal_fd = signalfd(-1, &signal_mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (signal_fd >= 0) {
+        loop.addFd(signal_fd, EPOLLIN, [&loop, signal_fd](uint32_t) {
+            struct signalfd_siginfo info;
+            if (read(signal_fd, &info, sizeof(info)) == sizeof(info)) {
+                std::cout << "Received signal " << info.ssi_signo << ", quitting..." << std::endl;
+                loop.stop();
             }
-            std::cout << std::dec << std::endl;
+        });
+    } else {
+        std::cerr << "Failed to create signalfd" << std::endl;
+    }
 
-            // 简单的命令处理
-            if (buffer[0] == 'q' || buffer[0] == 'Q') {
-                running = false;
-                std::cout << "Quitting..." << std::endl;
+    // 发送一帧：协议帧已编码在 encoder 的缓冲区中
+    protocol::FrameEncoder encoder;
+    auto sendFrame = [&](uint8_t type, const uint8_t* payload, size_t len) {
+        size_t size = encoder.encode(type, payload, len);
+        if (size > 0 && uart.send(encoder.data(), size) != static_cast<int>(size)) {
+            std::cerr << "Failed to send frame type " << static_cast<int>(type) << std::endl;
+        }
+    };
+
+    // 触发识别：取最新一帧、检测、立即回复
+    // 直接在事件循环线程中执行，省去线程切换；检测期间到达的串口数据留在内核缓冲区中
+    int64_t rx_time_us = 0; // 最近一次串口读取完成的时间，即触发帧的到达时间
+    uint64_t triggers = 0;
+    uint64_t triggers_without_frame = 0;
+    LatencyRecorder trigger_to_reply;
+    LatencyRecorder detect_time;
+    LatencyRecorder frame_age;
+    protocol::ResultBatch results;
+    std::vector<std::vector<cv::Point2f>> squares;
+    auto handleTrigger = [&]() {
+        int64_t trigger_us = rx_time_us;
+        ++triggers;
+
+        // 静态图像以触发时间作为采集时间；摄像头没有可用的帧时回复空批次，不记录帧龄
+        cv::Mat frame;
+        uint64_t frame_sequence = 0;
+        int64_t capture_us = trigger_us;
+        bool captured = false;
+        if (!static_image.empty()) {
+            frame = static_image;
+        } else if (grabber.latest(frame, frame_sequence, capture_us)) {
+            captured = true;
+        } else {
+            ++triggers_without_frame;
+        }
+
+        squares.clear();
+        int64_t detect_start = monotonicMicros();
+        if (!frame.empty()) {
+            pic_deal.setImage(frame);
+            pic_deal.detectSquares(squares);
+        }
+        int64_t detect_end = monotonicMicros();
+
+        // 按面积从小到大，一帧最多回复 kMaxResultsPerFrame 个结果
+        for (size_t i = 0; i < squares.size() && !results.full(); ++i) {
+            protocol::DetectionResult result;
+            float edge_sum = 0;
+            for (int j = 0; j < 4; ++j) {
+                result.corners[j][0] = squares[i][j].x;
+                result.corners[j][1] = squares[i][j].y;
+                edge_sum += static_cast<float>(cv::norm(squares[i][j] - squares[i][(j + 1) % 4]));
             }
-            // 在这里可以添加更多命令处理逻辑
+            result.edge_length = edge_sum / 4;
+            result.class_id = 0xFF;
+            result.timestamp_ms = static_cast<uint32_t>(capture_us / 1000);
+            results.add(result);
+        }
+
+        // 没有结果时也回复一个空批次，控制器不必等待超时
+        size_t size = results.flush(encoder);
+        if (size == 0) {
+            const uint8_t empty = 0;
+            size = encoder.encode(protocol::MSG_RESULTS, &empty, 1);
+        }
+        if (uart.send(encoder.data(), size) != static_cast<int>(size)) {
+            std::cerr << "Failed to send results" << std::endl;
         }
 
-        // 示例：图像处理
-        // cv::Mat gray_img = pic_deal.toGrayscale();
-        // cv::Mat binary_img = pic_deal.binarize(128);
-        // pic_deal.saveImage("processed_image.jpg");
+        // 回复时间不含回复在线路上的传输时间
+        int64_t reply_us = monotonicMicros();
+        trigger_to_reply.record(reply_us - trigger_us);
+        detect_time.record(detect_end - detect_start);
+        if (captured) {
+            frame_age.record(trigger_us - capture_us);
+        }
+    };
 
-        // 短暂延时
-        usleep(10000); // 10ms
-    }
+    // 命令处理：解析器只回调 CRC 校验通过的完整帧
+    protocol::FrameParser parser([&](const protocol::Frame& frame) {
+        switch (frame.type) {
+            case protocol::MSG_PING:
+                sendFrame(protocol::MSG_PONG, frame.payload, frame.length);
+                break;
+            case protocol::MSG_TRIGGER:
+                handleTrigger();
+                break;
+            case protocol::MSG_QUIT:
+                std::cout << "Quitting..." << std::endl;
+                loop.stop();
+                break;
+            default:
+                // 在这里可以添加更多命令处理逻辑
+                std::cerr << "Unknown frame type " << static_cast<int>(frame.type) << std::endl;
+                break;
+        }
+    });
+
+    // 串口数据到达时立即读入环形缓冲区并交给解析器，读取被拆分或合并都不影响帧边界
+    RingBuffer rx_buffer(4096);
+    uint64_t bytes_received = 0;
+    uint64_t read_events = 0;
+    loop.addFd(uart.fd(), EPOLLIN, [&](uint32_t events) {
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            std::cerr << "UART error or hangup, quitting..." << std::endl;
+            loop.removeFd(uart.fd());
+            loop.stop();
+            return;
+        }
+
+        long bytes_read = rx_buffer.readFromFd(uart.fd());
+        if (bytes_read <= 0) {
+            return;
+        }
+        rx_time_us = monotonicMicros();
+        bytes_received += static_cast<uint64_t>(bytes_read);
+        ++read_events;
+
+        uint8_t chunk[256];
+        while (rx_buffer.size() > 0) {
+            size_t len = rx_buffer.read(chunk, sizeof(chunk));
+            parser.feed(chunk, len);
+        }
+    });
+
+    // 周期输出统计信息
+    loop.addTimer(10000, [&]() {
+        const protocol::FrameParser::Stats& stats = parser.stats();
+        std::cout << "UART stats: " << bytes_received << " bytes in " << read_events << " reads, "
+                  << stats.frames << " frames, " << stats.crc_errors << " crc errors, "
+                  << stats.framing_errors << " framing errors, " << stats.sequence_gaps << " sequence gaps" << std::endl;
+        std::cout << "Trigger stats: " << triggers << " triggers, " << triggers_without_frame << " without frame, "
+                  << grabber.framesCaptured() << " frames captured, " << grabber.reconnects() << " camera reconnects"
+                  << std::endl;
+        printLatency("trigger_to_reply", trigger_to_reply);
+        printLatency("detect", detect_time);
+        printLatency("frame_age", frame_age);
+    });
+
+    // 主循环：阻塞在 epoll_wait，直到 stop 被调用
+    loop.run();
 
     // 清理资源
+    if (signal_fd >= 0) {
+        loop.removeFd(signal_fd);
+        close(signal_fd);
+    }
+    grabber.stop();
     uart.close();
     std::cout << "Firmware exited" << std::endl;
 
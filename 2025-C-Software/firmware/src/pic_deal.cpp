@@ -1,5 +1,6 @@
 #include "pic_deal.h"
 #include <iostream>
+#include <algorithm>
 
 PicDeal::PicDeal() {
     // 构造函数初始化
@@ -59,4 +60,73 @@ cv::Mat PicDeal::resize(int width, int height) {
 
 cv::Mat& PicDeal::getCurrentImage() {
     return current_image_;
+}
+
+void PicDeal::setImage(const cv::Mat& image) {
+    current_image_ = image;
+}
+
+bool PicDeal::detectSquares(std::vector<std::vector<cv::Point2f>>& squares) {
+    squares.clear();
+    if (current_image_.empty()) {
+        std::cerr << "No image to process" << std::endl;
+        return false;
+    }
+
+    // 灰度化、高斯模糊、边缘检测
+    if (current_image_.channels() == 1) {
+        gray_ = current_image_;
+    } else {
+        cv::cvtColor(current_image_, gray_, cv::COLOR_BGR2GRAY);
+    }
+    cv::GaussianBlur(gray_, blurred_, cv::Size(5, 5), 0);
+    cv::Canny(blurred_, edges_, 50, 150);
+    cv::findContours(edges_, contours_, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+    std::vector<std::pair<double, size_t>> areas;
+    std::vector<cv::Point> approx;
+    for (size_t i = 0; i < contours_.size(); ++i) {
+        // 多边形近似，只保留凸四边形
+        double epsilon = 0.04 * cv::arcLength(contours_[i], true);
+        cv::approxPolyDP(contours_[i], approx, epsilon, true);
+        if (approx.size() != 4 || !cv::isContourConvex(approx)) {
+            continue;
+        }
+
+        // 四边长度相近
+        double min_edge = cv::norm(approx[0] - approx[1]);
+        double max_edge = min_edge;
+        for (int j = 1; j < 4; ++j) {
+            double length = cv::norm(approx[j] - approx[(j + 1) % 4]);
+            min_edge = std::min(min_edge, length);
+            max_edge = std::max(max_edge, length);
+        }
+        if (max_edge - min_edge >= 0.1 * min_edge) {
+            continue;
+        }
+
+        // 正方形的circularity约为0.785
+        double area = cv::contourArea(approx);
+        double perimeter = cv::arcLength(approx, true);
+        double circularity = 4 * CV_PI * area / (perimeter * perimeter);
+        if (circularity <= 0.7 || circularity >= 0.85) {
+            continue;
+        }
+
+        std::vector<cv::Point2f> square;
+        for (size_t j = 0; j < approx.size(); ++j) {
+            square.push_back(cv::Point2f(approx[j]));
+        }
+        areas.push_back(std::make_pair(area, squares.size()));
+        squares.push_back(square);
+    }
+
+    // 按面积从小到大排序
+    std::sort(areas.begin(), areas.end());
+    std::vector<std::vector<cv::Point2f>> sorted(areas.size());
+    for (size_t i = 0; i < areas.size(); ++i) {
+        sorted[i].swap(squares[areas[i].second]);
+    }
+    squares.swap(sorted);
+    return true;
 }
\ No newline at end of file
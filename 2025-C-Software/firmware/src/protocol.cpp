@@ -0,0 +1,308 @@
+#include "protocol.h"
+#include <string.h>
+#include <math.h>
+
+namespace protocol {
+
+namespace {
+
+// 浮点数转 Q12.4 有符号定点数
+int16_t toQ12_4(float value) {
+    float scaled = roundf(value * 16.0f);
+    if (scaled > 32767.0f) {
+        return 32767;
+    }
+    if (scaled < -32768.0f) {
+        return -32768;
+    }
+    return static_cast<int16_t>(scaled);
+}
+
+// 浮点数转 Q12.4 无符号定点数
+uint16_t toUQ12_4(float value) {
+    float scaled = roundf(value * 16.0f);
+    if (scaled > 65535.0f) {
+        return 65535;
+    }
+    if (scaled < 0.0f) {
+        return 0;
+    }
+    return static_cast<uint16_t>(scaled);
+}
+
+void putU16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value & 0xFF);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void putU32(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value & 0xFF);
+    out[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+    out[2] = static_cast<uint8_t>((value >> 16) & 0xFF);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+uint16_t getU16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+uint32_t getU32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+           (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+// COBS 编码状态：边写入边编码，避免先拼出原始帧
+struct CobsWriter {
+    uint8_t* out;
+    size_t capacity;
+    size_t pos; // 下一个输出位置
+    size_t code_pos; // 当前块长度码的位置
+    uint8_t code; // 当前块长度码
+    bool ok;
+
+    CobsWriter(uint8_t* buffer, size_t cap) : out(buffer), capacity(cap), pos(1), code_pos(0), code(1), ok(cap > 0) {}
+
+    void put(uint8_t byte) {
+        if (!ok) {
+            return;
+        }
+        if (byte == 0) {
+            closeBlock();
+            return;
+        }
+        if (pos >= capacity) {
+            ok = false;
+            return;
+        }
+        out[pos++] = byte;
+        if (++code == 0xFF) {
+            closeBlock();
+        }
+    }
+
+    void closeBlock() {
+        if (pos >= capacity) {
+            ok = false;
+            return;
+        }
+        out[code_pos] = code;
+        code_pos = pos++;
+        code = 1;
+    }
+
+    // 写入最后一块的长度码和帧结尾，返回总长度
+    size_t finish() {
+        if (!ok || pos >= capacity) {
+            return 0;
+        }
+        out[code_pos] = code;
+        out[pos++] = 0x00;
+        return pos;
+    }
+};
+
+} // namespace
+
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc) {
+    for (size_t i = 0; i < len; ++i) {
+        crc ^= static_cast<uint16_t>(data[i] << 8);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+size_t encodeFrame(uint8_t type, uint8_t seq, const uint8_t* payload, size_t len, uint8_t* out, size_t out_capacity) {
+    if (len > kMaxPayload || (len > 0 && payload == NULL)) {
+        return 0;
+    }
+
+    uint8_t header[kHeaderSize] = {type, seq};
+    uint16_t crc = crc16(header, kHeaderSize);
+    crc = crc16(payload, len, crc);
+    uint8_t trailer[kCrcSize];
+    putU16(trailer, crc);
+
+    CobsWriter writer(out, out_capacity);
+    for (size_t i = 0; i < kHeaderSize; ++i) {
+        writer.put(header[i]);
+    }
+    for (size_t i = 0; i < len; ++i) {
+        writer.put(payload[i]);
+    }
+    for (size_t i = 0; i < kCrcSize; ++i) {
+        writer.put(trailer[i]);
+    }
+    return writer.finish();
+}
+
+FrameParser::FrameParser(FrameHandler handler)
+    : handler_(handler), length_(0), code_(0), remaining_(0), overflow_(false), has_last_seq_(false), last_seq_(0) {
+    // 构造函数初始化
+    memset(&stats_, 0, sizeof(stats_));
+}
+
+void FrameParser::feed(const uint8_t* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        uint8_t byte = data[i];
+        if (byte == 0x00) {
+            finishFrame();
+            continue;
+        }
+        if (overflow_) {
+            // 等待下一个 0x00 重新同步
+            continue;
+        }
+
+        if (remaining_ == 0) {
+            // 新块的长度码：上一块不是满块时，块之间隐含一个 0x00
+            if (code_ != 0 && code_ != 0xFF) {
+                if (length_ >= kMaxFrameSize) {
+                    overflow_ = true;
+                    continue;
+                }
+                buffer_[length_++] = 0x00;
+            }
+            code_ = byte;
+            remaining_ = static_cast<uint8_t>(byte - 1);
+            continue;
+        }
+
+        if (length_ >= kMaxFrameSize) {
+            overflow_ = true;
+            continue;
+        }
+        buffer_[length_++] = byte;
+        --remaining_;
+    }
+}
+
+void FrameParser::finishFrame() {
+    // 连续的 0x00 视为空闲，不计错误
+    bool empty = length_ == 0 && code_ == 0 && !overflow_;
+    bool valid = !overflow_ && remaining_ == 0 && length_ >= kHeaderSize + kCrcSize;
+
+    if (!empty && !valid) {
+        ++stats_.framing_errors;
+    } else if (valid) {
+        size_t body = length_ - kCrcSize;
+        if (crc16(buffer_, body) != getU16(buffer_ + body)) {
+            ++stats_.crc_errors;
+        } else {
+            ++stats_.frames;
+            uint8_t seq = buffer_[1];
+            if (has_last_seq_ && seq != static_cast<uint8_t>(last_seq_ + 1)) {
+                ++stats_.sequence_gaps;
+            }
+            has_last_seq_ = true;
+            last_seq_ = seq;
+
+            Frame frame;
+            frame.type = buffer_[0];
+            frame.seq = seq;
+            frame.payload = buffer_ + kHeaderSize;
+            frame.length = body - kHeaderSize;
+            if (handler_) {
+                handler_(frame);
+            }
+        }
+    }
+    reset();
+}
+
+void FrameParser::reset() {
+    length_ = 0;
+    code_ = 0;
+    remaining_ = 0;
+    overflow_ = false;
+}
+
+const FrameParser::Stats& FrameParser::stats() const {
+    return stats_;
+}
+
+FrameEncoder::FrameEncoder() : size_(0), seq_(0) {
+    // 构造函数初始化
+}
+
+size_t FrameEncoder::encode(uint8_t type, const uint8_t* payload, size_t len) {
+    size_ = encodeFrame(type, seq_, payload, len, buffer_, sizeof(buffer_));
+    if (size_ > 0) {
+        ++seq_;
+    }
+    return size_;
+}
+
+const uint8_t* FrameEncoder::data() const {
+    return buffer_;
+}
+
+size_t FrameEncoder::size() const {
+    return size_;
+}
+
+ResultBatch::ResultBatch() : count_(0) {
+    // 构造函数初始化
+}
+
+bool ResultBatch::add(const DetectionResult& result) {
+    if (full()) {
+        return false;
+    }
+
+    uint8_t* out = payload_ + 1 + count_ * kResultSize;
+    for (int i = 0; i < 4; ++i) {
+        putU16(out, static_cast<uint16_t>(toQ12_4(result.corners[i][0])));
+        putU16(out + 2, static_cast<uint16_t>(toQ12_4(result.corners[i][1])));
+        out += 4;
+    }
+    putU16(out, toUQ12_4(result.edge_length));
+    out[2] = result.class_id;
+    putU32(out + 3, result.timestamp_ms);
+
+    ++count_;
+    return true;
+}
+
+size_t ResultBatch::flush(FrameEncoder& encoder) {
+    if (count_ == 0) {
+        return 0;
+    }
+    payload_[0] = static_cast<uint8_t>(count_);
+    size_t size = encoder.encode(MSG_RESULTS, payload_, 1 + count_ * kResultSize);
+    count_ = 0;
+    return size;
+}
+
+size_t ResultBatch::count() const {
+    return count_;
+}
+
+bool ResultBatch::full() const {
+    return count_ >= kMaxResultsPerFrame;
+}
+
+int decodeResults(const uint8_t* payload, size_t len, DetectionResult* results, size_t max_results) {
+    if (len < 1 || len != 1 + payload[0] * kResultSize) {
+        return -1;
+    }
+
+    size_t count = payload[0] < max_results ? payload[0] : max_results;
+    const uint8_t* in = payload + 1;
+    for (size_t n = 0; n < count; ++n) {
+        DetectionResult& result = results[n];
+        for (int i = 0; i < 4; ++i) {
+            result.corners[i][0] = static_cast<int16_t>(getU16(in)) / 16.0f;
+            result.corners[i][1] = static_cast<int16_t>(getU16(in + 2)) / 16.0f;
+            in += 4;
+        }
+        result.edge_length = getU16(in) / 16.0f;
+        result.class_id = in[2];
+        result.timestamp_ms = getU32(in + 3);
+        in += kResultSize - 16;
+    }
+    return static_cast<int>(count);
+}
+
+} // namespace protocol
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "ring_buffer.h"
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+namespace {
+
+// 向上取整为2的幂
+size_t roundUpPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+RingBuffer::RingBuffer(size_t capacity)
+    : buffer_(roundUpPowerOfTwo(capacity > 0 ? capacity : 1)),
+      mask_(buffer_.size() - 1),
+      read_pos_(0),
+      write_pos_(0) {
+    // 构造函数初始化
+}
+
+size_t RingBuffer::write(const uint8_t* data, size_t len) {
+    if (len > space()) {
+        len = space();
+    }
+    // 分两段拷贝：写位置到末尾，再从开头
+    size_t offset = write_pos_ & mask_;
+    size_t first = len < buffer_.size() - offset ? len : buffer_.size() - offset;
+    memcpy(&buffer_[offset], data, first);
+    memcpy(&buffer_[0], data + first, len - first);
+    write_pos_ += len;
+    return len;
+}
+
+size_t RingBuffer::read(uint8_t* data, size_t len) {
+    len = peek(data, len);
+    read_pos_ += len;
+    return len;
+}
+
+size_t RingBuffer::peek(uint8_t* data, size_t len) const {
+    if (len > size()) {
+        len = size();
+    }
+    size_t offset = read_pos_ & mask_;
+    size_t first = len < buffer_.size() - offset ? len : buffer_.size() - offset;
+    memcpy(data, &buffer_[offset], first);
+    memcpy(data + first, &buffer_[0], len - first);
+    return len;
+}
+
+uint8_t RingBuffer::at(size_t index) const {
+    return buffer_[(read_pos_ + index) & mask_];
+}
+
+void RingBuffer::discard(size_t len) {
+    read_pos_ += len < size() ? len : size();
+}
+
+long RingBuffer::readFromFd(int fd) {
+    size_t free_space = space();
+    if (free_space == 0) {
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    // 空闲区域最多分为两段，用 readv 一次读入
+    size_t offset = write_pos_ & mask_;
+    size_t first = free_space < buffer_.size() - offset ? free_space : buffer_.size() - offset;
+    struct iovec iov[2];
+    iov[0].iov_base = &buffer_[offset];
+    iov[0].iov_len = first;
+    iov[1].iov_base = &buffer_[0];
+    iov[1].iov_len = free_space - first;
+
+    ssize_t n = readv(fd, iov, iov[1].iov_len > 0 ? 2 : 1);
+    if (n > 0) {
+        write_pos_ += static_cast<size_t>(n);
+    }
+    return static_cast<long>(n);
+}
+
+void RingBuffer::clear() {
+    read_pos_ = write_pos_;
+}
+
+size_t RingBuffer::size() const {
+    return write_pos_ - read_pos_;
+}
+
+size_t RingBuffer::space() const {
+    return buffer_.size() - size();
+}
+
+size_t RingBuffer::capacity() const {
+    return buffer_.size();
+}
\ No newline at end of file
@@ -85,7 +85,9 @@ bool UART::init(const std::string& port, uint32_t baud_rate, uint8_t parity, uin
 
     // 设置其他选项
     options.c_cflag |= (CLOCAL | CREAD);
-    options.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG);
+    options.c_lflag &= ~(ICANON | ECHO | ECHOE | ISIG | IEXTEN);
+    // 二进制数据：关闭软件流控和回车换行转换，否则 0x0D/0x11/0x13 会被改写或吞掉
+    options.c_iflag &= ~(IXON | IXOFF | IXANY | ICRNL | INLCR | IGNCR | ISTRIP | BRKINT | PARMRK);
     options.c_oflag &= ~OPOST;
     options.c_cc[VMIN] = 1;
     options.c_cc[VTIME] = 0;
@@ -156,4 +158,8 @@ void UART::close() {
 
 bool UART::isOpen() const {
     return is_open_;
+}
+
+int UART::fd() const {
+    return serial_fd_;
 }
\ No newline at end of file